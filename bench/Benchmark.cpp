@@ -0,0 +1,172 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * Benchmark of the engines on a generated morphology
+ * with the site density of input/sites.txt. Reports
+ * the events per second of a batch of replicas run
+ * one after another with KmcRun (with the electron
+ * only and the all types event loop, exact and fast
+ * math rates) and in lockstep with ReplicaBatch, and the
+ * throughput of the rate functions themselves.
+ *
+ * Usage: kmc_bench [nrOfReplicas] [nrOfSteps] [nrOfSites]
+ **************************************************/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <functional>
+#include <boost/format.hpp>
+#include "KmcRun.h"
+#include "ModelParameters.h"
+#include "ReplicaBatch.h"
+
+namespace {
+
+ModelParameters makeParameters(double boxSize, int nrOfCarriers) {
+	ModelParameters params;
+	params.SEED = 12345;
+	params.sR_CutOff = 20.0;
+	params.lR_CutOff = 20.0;
+	params.Xmax = params.Ymax = params.Zmax = boxSize;
+	params.qt = { nrOfCarriers, 0, 0, 0 };
+	params.DOS_mu = { 1.5, 1.5, 1.5, 1.5 };
+	params.DOS_sigma = { 0.052, 0.026, 0.026, 0.026 };
+	params.charge = { -1.0, 1.0, 0.0, 0.0 };
+	params.v0 = { 1.0, 1.0, 1.0, 1.0 };
+	params.alpha = { 0.15, 0.15, 0.15, 0.15 };
+	params.kBT = 0.026;
+	params.E_Field = 0.01;
+	params.options.verbose = false;
+	params.options.write_output = false;
+	return params;
+}
+
+/* Returns the wall time of f in seconds */
+double timeIt(const std::function<void()>& f) {
+	auto begin = std::chrono::steady_clock::now();
+	f();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(end - begin).count();
+}
+
+void report(const std::string& name, long events, double seconds, double reference) {
+	double rate = events / seconds;
+	std::cout << boost::format("%-24s %12d %10.3f %14.0f %8.2fx\n") % name % events % seconds % rate % (reference > 0.0 ? rate / reference : 1.0);
+}
+
+template <int Lanes>
+void benchReplicaBatch(const ModelParameters& params, const std::vector<Eigen::Vector3d>& morphology, int nrOfReplicas, long nrOfSteps, double reference) {
+	long events = 0;
+	double seconds = timeIt([&]() {
+		for (int r = 0; r < nrOfReplicas; r += Lanes) {
+			ReplicaBatch<Lanes> batch(params, morphology, PType::elec, r);
+			batch.runSteps(nrOfSteps);
+			for (int l = 0; l < Lanes; ++l) {
+				events += batch.getNrOfHops(l);
+			}
+		}
+	});
+	report(str(boost::format("ReplicaBatch<%d>") % Lanes), events, seconds, reference);
+}
+
+/* Evaluates the Miller-Abrahams and Forster rates of all short range pairs a number of times, exact and fast */
+void benchRates(const ModelParameters& params, const std::vector<Eigen::Vector3d>& morphology) {
+	KmcRun run{ params };
+	run.setSites(morphology);
+	run.initialize();
+	const std::vector<Site>& sites = run.getSites();
+	RateEngine exact(params.v0, params.alpha, params.charge, params.E_Field, params.kBT, PBC(params.Xmax, params.Ymax, params.Zmax));
+	RateEngine fast = exact;
+	fast.setFastMath(true);
+
+	std::cout << "\nrate functions, all short range pairs x 20\n";
+	std::cout << boost::format("%-24s %12s %10s %14s %9s\n") % "rates" % "calls" % "seconds" % "calls/s" % "speedup";
+	for (const auto& name : { "millerAbrahams", "forster" }) {
+		bool forster = std::string(name) == "forster";
+		double exactRate = 0.0;
+		for (const RateEngine* engine : { &exact, &fast }) {
+			long calls = 0;
+			double sum = 0.0;
+			double seconds = timeIt([&]() {
+				for (int repeat = 0; repeat < 20; ++repeat) {
+					for (const auto& site : sites) {
+						for (int nb : site.getSRNeighbours()) {
+							sum += forster ? engine->forster(site, sites[nb]) : engine->millerAbrahams(site, sites[nb], PType::elec);
+							calls++;
+						}
+					}
+				}
+			});
+			if (engine == &exact) {
+				exactRate = calls / seconds;
+			}
+			report(str(boost::format("%s (%s)") % name % (engine == &exact ? "exact" : "fast")), calls, seconds, exactRate);
+			if (sum < 0.0) std::cout << sum; // keeps the loop from being optimised away
+		}
+	}
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	int nrOfReplicas = (argc > 1) ? std::stoi(argv[1]) : 32;
+	long nrOfSteps = (argc > 2) ? std::stol(argv[2]) : 5000;
+	int nrOfSites = (argc > 3) ? std::stoi(argv[3]) : 2000;
+	const int nrOfCarriers = 8;
+
+	/* Same site density as input/sites.txt (13824 sites in a box of 203.463) */
+	double boxSize = 203.463 * std::cbrt(nrOfSites / 13824.0);
+	std::mt19937_64 rng(2020);
+	std::uniform_real_distribution<double> coord(0.0, boxSize);
+	std::vector<Eigen::Vector3d> morphology;
+	for (int i = 0; i < nrOfSites; ++i) {
+		double x = coord(rng), y = coord(rng), z = coord(rng);
+		morphology.emplace_back(x, y, z);
+	}
+	ModelParameters params = makeParameters(boxSize, nrOfCarriers);
+
+	std::cout << nrOfReplicas << " replicas of " << nrOfSteps << " steps, " << nrOfSites << " sites, " << nrOfCarriers << " electrons per replica\n";
+	std::cout << "(setup of the neighbour lists included in the timings)\n";
+	std::cout << boost::format("%-24s %12s %10s %14s %9s\n") % "engine" % "events" % "seconds" % "events/s" % "speedup";
+
+	auto runSerial = [&](const std::function<void(RunOptions&)>& configure) {
+		long events = 0;
+		RunOptions defaults = params.options;
+		configure(params.options);
+		double seconds = timeIt([&]() {
+			for (int r = 0; r < nrOfReplicas; ++r) {
+				params.SEED = 12345 + r;
+				KmcRun run{ params };
+				run.setSites(morphology);
+				events += run.runSteps(nrOfSteps);
+			}
+		});
+		params.SEED = 12345;
+		params.options = defaults;
+		return std::make_pair(events, seconds);
+	};
+	auto [events, seconds] = runSerial([](RunOptions&) {});
+	double reference = events / seconds;
+	report("KmcRun (serial)", events, seconds, reference);
+	auto [fullEvents, fullSeconds] = runSerial([](RunOptions& opt) { opt.specialize_types = false; });
+	report("KmcRun (all types loop)", fullEvents, fullSeconds, reference);
+	auto [fastEvents, fastSeconds] = runSerial([](RunOptions& opt) { opt.fast_math = true; });
+	report("KmcRun (fast math)", fastEvents, fastSeconds, reference);
+	auto [batchEvents, batchSeconds] = runSerial([](RunOptions& opt) { opt.batch = true; });
+	report("KmcRun (batch mode)", batchEvents, batchSeconds, reference);
+	benchReplicaBatch<4>(params, morphology, nrOfReplicas, nrOfSteps, reference);
+	benchReplicaBatch<8>(params, morphology, nrOfReplicas, nrOfSteps, reference);
+
+	benchRates(params, morphology);
+
+	return 0;
+}
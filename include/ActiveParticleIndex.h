@@ -0,0 +1,38 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * ActiveParticleIndex keeps the IDs of the living
+ * particles grouped by type, so the event loop can
+ * iterate over one dense range per type. Particles
+ * are inserted, moved and removed in O(1), removal
+ * swaps the last entry of the type into the gap.
+ *
+ **************************************************/
+#pragma once
+#include <vector>
+#include <array>
+#include "Particle.h"
+#include "EnumNames.h"
+
+class ActiveParticleIndex {
+public:
+    /* Brings the entry of a particle in line with its current state (alive or not, type) */
+    void update(int partID, const Particle& part);
+    void clear();
+
+    const std::vector<int>& getParticles(PType type) const { return members[type]; }
+    int getNrOfParticles(PType type) const { return members[type].size(); }
+
+private:
+    std::array<std::vector<int>, 5> members;
+    std::vector<int> position; // position of a particle in the range of its type
+    std::vector<int> indexedType; // type under which a particle is indexed, -1 if not indexed
+
+    void insert(int partID, PType type);
+    void remove(int partID);
+};
@@ -0,0 +1,101 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * CellList is a spatial index of the sites. The
+ * (periodic) box is divided in cubic cells with
+ * sides of at least cellSize, so a search within a
+ * cut-off only has to look at the surrounding cells.
+ *
+ **************************************************/
+#pragma once
+#include <vector>
+#include <array>
+#include <cmath>
+#include <Eigen/Dense>
+#include "PBC.h"
+
+class CellList {
+public:
+    CellList(const PBC& pbc, double cellSize);
+
+    /* Adds a site to the index, the sites are numbered in the order they are added */
+    void addSite(const Eigen::Vector3d& coord);
+    /* Returns all sites within cutOff of coord (PBC corrected) except the site "exclude", in no particular order */
+    std::vector<int> sitesWithin(const Eigen::Vector3d& coord, double cutOff, int exclude = -1) const;
+    /* Calls f(site, dr) for all sites within cutOff of coord except "exclude", dr points from coord to the
+       (nearest image of the) site. The sites are visited in a fixed order (cell by cell). */
+    template <typename F>
+    void forEachSiteWithin(const Eigen::Vector3d& coord, double cutOff, int exclude, F f) const;
+
+    int getNrOfSites() const { return nrOfSites; }
+
+private:
+    PBC pbc;
+    Eigen::Vector3d box;
+    std::array<int, 3> nrOfCells;
+    Eigen::Vector3d cellSide;
+    std::vector<std::vector<int>> cells;
+    std::vector<std::vector<Eigen::Vector3d>> cellCoordinates; // positions in the box, stored per cell for locality
+    int nrOfSites = 0;
+
+    /* Cell of a position in the box */
+    std::array<int, 3> cellOf(const Eigen::Vector3d& pos) const;
+    int cellIndex(int x, int y, int z) const { return (x * nrOfCells[1] + y) * nrOfCells[2] + z; }
+};
+
+template <typename F>
+void CellList::forEachSiteWithin(const Eigen::Vector3d& coord, double cutOff, int exclude, F f) const {
+    Eigen::Vector3d pos = pbc.updatePostionPBC(coord);
+    std::array<int, 3> centre = cellOf(pos);
+    std::array<int, 3> reach;
+    bool coversBox = false;
+    for (int d = 0; d < 3; ++d) {
+        reach[d] = int(std::ceil(cutOff / cellSide[d]));
+        coversBox = coversBox || (2 * reach[d] + 1 > nrOfCells[d]);
+    }
+
+    if (coversBox) { // the cut-off spans the whole box in some direction, visit every cell once with the nearest image of every site
+        for (unsigned int c = 0; c < cells.size(); ++c) {
+            for (unsigned int k = 0; k < cells[c].size(); ++k) {
+                Eigen::Vector3d dr = pbc.dr_PBC_corrected(pos, cellCoordinates[c][k]);
+                if (cells[c][k] != exclude && dr.norm() <= cutOff) {
+                    f(cells[c][k], dr);
+                }
+            }
+        }
+        return;
+    }
+
+    /* Every neighbouring cell is visited once, shifted to the periodic image next to the centre cell */
+    const double cutOff2 = cutOff * cutOff;
+    for (int x = centre[0] - reach[0]; x <= centre[0] + reach[0]; ++x) {
+        if (!pbc.isPeriodicX() && (x < 0 || x >= nrOfCells[0])) {
+            continue; // no images through an open boundary
+        }
+        int wx = (x + nrOfCells[0]) % nrOfCells[0];
+        double sx = (x < 0) ? -box[0] : (x >= nrOfCells[0]) ? box[0] : 0.0;
+        for (int y = centre[1] - reach[1]; y <= centre[1] + reach[1]; ++y) {
+            int wy = (y + nrOfCells[1]) % nrOfCells[1];
+            double sy = (y < 0) ? -box[1] : (y >= nrOfCells[1]) ? box[1] : 0.0;
+            for (int z = centre[2] - reach[2]; z <= centre[2] + reach[2]; ++z) {
+                int wz = (z + nrOfCells[2]) % nrOfCells[2];
+                double sz = (z < 0) ? -box[2] : (z >= nrOfCells[2]) ? box[2] : 0.0;
+                Eigen::Vector3d origin(sx - pos[0], sy - pos[1], sz - pos[2]);
+                int c = cellIndex(wx, wy, wz);
+                const std::vector<int>& sites = cells[c];
+                const std::vector<Eigen::Vector3d>& coords = cellCoordinates[c];
+                for (unsigned int k = 0; k < sites.size(); ++k) {
+                    Eigen::Vector3d dr = coords[k] + origin;
+                    if (dr.squaredNorm() <= cutOff2 && sites[k] != exclude) {
+                        f(sites[k], dr);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * DisorderGenerator creates spatially correlated
+ * energetic disorder. Every site carries a randomly
+ * oriented dipole, the energy of a charge on a site
+ * follows from the potential of all dipoles within
+ * a cut-off (found with a cell list, PBC corrected),
+ * with a soft core to regularise close pairs.
+ * The sum is split over threads by site, so the
+ * result only depends on the seed.
+ *
+ **************************************************/
+#pragma once
+#include <vector>
+#include <Eigen/Dense>
+#include "PBC.h"
+#include "RandomEngine.h"
+
+class DisorderGenerator {
+public:
+    /* A cut-off <= 0 uses three times the mean site spacing, nrOfThreads <= 0 one thread per core */
+    DisorderGenerator(const PBC& pbc, double cutOff, int nrOfThreads) : pbc(pbc), cutOff(cutOff), nrOfThreads(nrOfThreads) {}
+
+    /* Returns the dipole potential of every site, shifted and scaled to mean 0 and standard deviation 1.
+       The dipole orientations are drawn from rng. */
+    std::vector<double> dipolarPotential(const std::vector<Eigen::Vector3d>& coordinates, RandomEngine& rng) const;
+
+private:
+    PBC pbc;
+    double cutOff;
+    int nrOfThreads;
+};
@@ -0,0 +1,65 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * EdgeFlux counts the hops over every (directed)
+ * pair of sites, per particle type. Dense counters
+ * are aligned with the short range neighbour lists
+ * (one 64 bit counter per list entry), hops that are
+ * not in those lists (Forster hops) and types in
+ * sparse mode are counted in a hash map instead.
+ * In automatic mode a type starts sparse and turns
+ * dense once the map would use more memory.
+ *
+ **************************************************/
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include "Site.h"
+#include "EnumNames.h"
+
+class EdgeFlux {
+public:
+    enum class Mode { off, dense, sparse, automatic };
+
+    /* Must be called after the short range neighbour lists are built */
+    void initialize(const std::vector<Site>& siteList, Mode mode);
+    /* Sets all counters to zero */
+    void reset();
+    bool isEnabled() const { return mode != Mode::off; }
+    bool isDense(PType type) const { return !dense[type].empty(); }
+
+    void recordHop(PType type, int from, int to, const std::vector<Site>& siteList) {
+        size_t slot = dense[type].empty() ? npos : slotOf(from, to, siteList);
+        if (slot != npos) {
+            dense[type][slot]++;
+        }
+        else {
+            recordSparseHop(type, from, to, siteList);
+        }
+    }
+    /* Number of hops from -> to */
+    long getHops(PType type, int from, int to, const std::vector<Site>& siteList) const;
+    /* Calls f(type, from, to, net) for every pair from < to with a net number of hops (from -> to minus to -> from) that is not zero */
+    void forEachNetFlux(const std::vector<Site>& siteList, const std::function<void(PType, int, int, long)>& f) const;
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    Mode mode = Mode::off;
+    std::vector<size_t> offsets; // the counters of site i start at offsets[i]
+    std::array<std::vector<uint64_t>, 4> dense; // 64 bit, a single edge can see more than 2^32 hops in long runs
+    std::array<std::unordered_map<uint64_t, uint64_t>, 4> sparse;
+
+    static uint64_t key(int from, int to) { return (uint64_t(uint32_t(from)) << 32) | uint32_t(to); }
+    /* Position of the hop in the dense counters, npos if "to" is not a short range neighbour of "from" */
+    size_t slotOf(int from, int to, const std::vector<Site>& siteList) const;
+    void recordSparseHop(PType type, int from, int to, const std::vector<Site>& siteList);
+    void makeDense(PType type, const std::vector<Site>& siteList);
+};
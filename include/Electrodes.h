@@ -0,0 +1,67 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * Electrodes at the open x boundaries of the box,
+ * the left one at x = 0 and the right one at
+ * x = Xmax. An electrode injects carriers into the
+ * free sites within its range and extracts carriers
+ * from the sites within its range, with Miller-
+ * Abrahams rates between the site and the electrode
+ * level (distance measured along x). The injection
+ * rates of the free sites are kept in a FenwickTree
+ * per electrode, so the total injection rate is a
+ * single event and the site is drawn in O(log N).
+ *
+ **************************************************/
+#pragma once
+#include <vector>
+#include <array>
+#include "Site.h"
+#include "RateEngine.h"
+#include "FenwickTree.h"
+#include "EnumNames.h"
+
+class Electrodes {
+public:
+    enum Side { left = 0, right = 1 };
+
+    /* Finds the sites within range of both electrodes and their injection and extraction rates,
+       level[side] is the energy of a carrier in that electrode. All sites start free. */
+    void initialize(const std::vector<Site>& siteList, const RateEngine& rate_engine, PType carrier, double boxX, double range, std::array<double, 2> level);
+    bool isEnabled() const { return enabled; }
+    PType getCarrier() const { return carrier; }
+    int getNrOfSitesInRange(int side) const { return zoneSites[side].size(); }
+
+    /* Total injection rate of an electrode into the free sites within its range */
+    double getInjectionRate(int side) const { return injectionTrees[side].getTotal(); }
+    /* Draws the site of an injection (random01 in [0, 1)), -1 if no site in range is free */
+    int selectInjectionSite(int side, double random01) const;
+    /* Extraction rate of a carrier on a site into an electrode, zero if the site is out of range */
+    double getExtractionRate(int side, int site) const { return extractionRates[site][side]; }
+    /* Keeps the injection rates up to date, must be called whenever a carrier takes or leaves a site */
+    void setOccupied(int site, bool occupied);
+
+    void recordInjection(int side) { injected[side]++; }
+    void recordExtraction(int side) { extracted[side]++; }
+    long getInjected(int side) const { return injected[side]; }
+    long getExtracted(int side) const { return extracted[side]; }
+    /* Sets the counters to zero */
+    void reset() { injected.fill(0); extracted.fill(0); }
+
+private:
+    bool enabled = false;
+    PType carrier = PType::elec;
+    std::array<std::vector<int>, 2> zoneSites; // sites within range of each electrode
+    std::array<std::vector<double>, 2> injectionRates; // per zone site
+    std::vector<FenwickTree> injectionTrees; // injection rates of the free zone sites
+    std::vector<std::array<int, 2>> zoneIndex; // per site, its index in zoneSites or -1
+    std::vector<std::array<double, 2>> extractionRates; // per site
+    long updatesSinceRebuild = 0;
+    std::array<long, 2> injected{ 0 };
+    std::array<long, 2> extracted{ 0 };
+};
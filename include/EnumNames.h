@@ -16,6 +16,13 @@
 enum PType { elec = 0, hole = 1, trip = 2, sing = 3, CT = 4 };
 
 enum Transition { normalhop = 0, decay, excitonFromElec, excitonFromHole, excitonFromElecCT, excitonFromHoleCT, 
-                    singToCTViaElec, singToCTViaHole, tripToCTViaElec, tripToCTViaHole, CTdisViaHole, CTdisViaElec};
+                    singToCTViaElec, singToCTViaHole, tripToCTViaElec, tripToCTViaHole, CTdisViaHole, CTdisViaElec, superbasinExit,
+                    injection, extraction};
+
+const int nrOfTransitions = Transition::extraction + 1;
+
+/* Sets of particle types (bit t is PType t) that can occur in a run, the event loop is compiled for each of them.
+   A single carrier type is closed: without a partner no excitons or CT states can form. */
+enum TypeSet : unsigned { elecOnly = 1u << PType::elec, holeOnly = 1u << PType::hole, allTypes = 0x1fu };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * FastMath contains the approximations used by the
+ * fast math rate mode. exp(x) is computed as
+ * 2^k * 2^(j/64) * p(r), with 2^(j/64) from a table
+ * and p a degree 4 polynomial on |r| <= ln2/128
+ * (the same scheme as the C library, without FMA).
+ * The relative error is below maxExpError (the
+ * truncation error of p is 4e-14, the rounding adds
+ * a few ulp), x^6 is computed by multiplication.
+ *
+ **************************************************/
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace FastMath {
+
+constexpr double maxExpError = 1e-13;
+constexpr int tableBits = 6;
+constexpr int tableSize = 1 << tableBits;
+
+/* Bits of 2^(j/64) for j = 0..63 (correctly rounded by std::exp2), minus j << 46. Adding n << 46 for n = 64 k + j
+   then gives the bits of 2^k * 2^(j/64) with a single integer addition. */
+inline const std::array<uint64_t, tableSize> expTable = []() {
+    std::array<uint64_t, tableSize> table;
+    for (int j = 0; j < tableSize; ++j) {
+        double value = std::exp2(double(j) / tableSize);
+        std::memcpy(&table[j], &value, sizeof(value));
+        table[j] -= uint64_t(j) << (52 - tableBits);
+    }
+    return table;
+}();
+
+inline double exp(double x) {
+    /* Outside this range the result is not a normal double (or x is NaN), leave it to the library */
+    if (!(x > -700.0 && x < 700.0)) {
+        return std::exp(x);
+    }
+    constexpr double tableSizeOverLn2 = tableSize / 0.693147180559945309417232121458;
+    constexpr double ln2OverSizeHi = 0x1.62e42feep-1 / tableSize; // ln2 / 64 split in two parts, n * hi is exact
+    constexpr double ln2OverSizeLo = 0x1.a39ef35793c76p-33 / tableSize; // for |n| < 2^21, so r is accurate
+    constexpr double shifter = 0x1.8p52; // x * 64 / ln2 + shifter holds n = round(x * 64 / ln2) in its low bits
+
+    double shifted = x * tableSizeOverLn2 + shifter;
+    uint64_t nBits;
+    std::memcpy(&nBits, &shifted, sizeof(nBits));
+    double nd = shifted - shifter;
+    double r = (x - nd * ln2OverSizeHi) - nd * ln2OverSizeLo;
+
+    /* The high bits of the shifter are shifted out, what is left is n << 46 modulo 2^64 */
+    uint64_t scaleBits = expTable[nBits & (tableSize - 1)] + (nBits << (52 - tableBits));
+    double scale;
+    std::memcpy(&scale, &scaleBits, sizeof(scale));
+
+    /* exp(r) - 1 to degree 4, split so the dependency chain stays short */
+    double r2 = r * r;
+    double tail = (r + r2 * (1.0 / 2.0 + r * (1.0 / 6.0))) + (r2 * r2) * (1.0 / 24.0);
+    return scale + scale * tail;
+}
+
+inline double pow6(double x) {
+    double x2 = x * x;
+    return x2 * x2 * x2;
+}
+
+}
@@ -0,0 +1,35 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * FenwickTree (binary indexed tree) of non-negative
+ * weights. Changing a weight and selecting an index
+ * with probability proportional to its weight both
+ * take O(log N), so items can be drawn without
+ * replacement by setting their weight to zero.
+ *
+ **************************************************/
+#pragma once
+#include <vector>
+
+class FenwickTree {
+public:
+    explicit FenwickTree(const std::vector<double>& weights);
+
+    void setWeight(int index, double weight);
+    /* Recomputes the partial sums from the weights, they pick up rounding errors after many updates */
+    void rebuild();
+    double getWeight(int index) const { return weights[index]; }
+    double getTotal() const;
+    /* Returns the index whose cumulative weight interval contains value (0 <= value < total), never an index with zero weight */
+    int find(double value) const;
+
+private:
+    std::vector<double> weights;
+    std::vector<double> tree; // tree[i] holds the sum of the weights (i - lowbit(i), i], 1-based
+    int highestPower = 1; // largest power of two <= number of weights
+};
@@ -19,28 +19,82 @@
 #include "NextEventList.h"
 #include "EnumNames.h"
 #include "OutputManager.h"
+#include "RunOptions.h"
+#include "Superbasin.h"
+#include "ModelParameters.h"
+#include "CellList.h"
+#include "EdgeFlux.h"
+#include "ActiveParticleIndex.h"
+#include "Telemetry.h"
+#include "DisorderGenerator.h"
+#include "Electrodes.h"
+#include "WorkerPool.h"
+#include <memory>
+#include <list>
 
 class KmcRun {
 public:
-    KmcRun(RateEngine rate_engine, PBC pbc, RandomEngine random_engine, int nrOfSteps, std::array<int,4> qt, std::string siteFile, double sR_CutOff, double lR_CutOff) :
-        rate_engine(rate_engine), pbc(pbc), random_engine(random_engine), nrOfSteps(nrOfSteps), nrOfParticlesPerType(qt) ,siteFile(siteFile), sR_cutOff(sR_CutOff), lR_cutOff(lR_CutOff) {
+    KmcRun(RateEngine rate_engine, PBC pbc, RandomEngine random_engine, int nrOfSteps, std::array<int,4> qt, std::string siteFile, double sR_CutOff, double lR_CutOff, RunOptions options = RunOptions{}) :
+        rate_engine(rate_engine), pbc(pbc), random_engine(random_engine), cellList(pbc, sR_CutOff), nrOfSteps(nrOfSteps), nrOfParticlesPerType(qt) ,siteFile(siteFile), sR_cutOff(sR_CutOff), lR_cutOff(lR_CutOff), options(options) {
             int totalNrOfParticles = 0;
             totalNrOfParticles = std::accumulate(nrOfParticlesPerType.begin(), nrOfParticlesPerType.end(), totalNrOfParticles);
-            next_event_list.initializeListSize(totalNrOfParticles * 100); // create space for at least a 100 events per particles
-            std::cout << "Initial number of particles in the simulation: " << totalNrOfParticles << "\n";
+            next_event_list.initializeListSize(std::max(totalNrOfParticles, 1) * 100); // create space for at least a 100 events per particles
+            next_event_list.setVerbose(options.verbose);
+            timeLimit = options.max_time;
+            this->rate_engine.setFastMath(options.fast_math);
+            if (options.electrodes) { // open in x
+                this->pbc.setPeriodicX(false);
+                this->rate_engine.setPeriodicX(false);
+                cellList = CellList(this->pbc, sR_CutOff);
+            }
+            log() << "Initial number of particles in the simulation: " << totalNrOfParticles << "\n";
         }
+    /* Sets up a run from in-memory parameters, without a site file the sites must be given with setSites() */
+    explicit KmcRun(const ModelParameters& params, std::string siteFile = "") :
+        KmcRun(RateEngine(params.v0, params.alpha, params.charge, params.E_Field, params.kBT, PBC(params.Xmax, params.Ymax, params.Zmax)),
+            PBC(params.Xmax, params.Ymax, params.Zmax), RandomEngine(params.SEED, params.DOS_mu, params.DOS_sigma),
+            params.nrOfSteps, params.qt, siteFile, params.sR_CutOff, params.lR_CutOff, params.options) {}
+
+    /* Runs nrOfSteps steps, reports on the console and writes the output files */
     void runSimulation();
 
+    /* In-memory setup, used instead of the site file. The energies (elec, hole, trip, sing) are
+       drawn from the DOS when they are not given. Must be called before initialize(). */
+    void setSites(const std::vector<Eigen::Vector3d>& coordinates);
+    void setSites(const std::vector<Eigen::Vector3d>& coordinates, const std::vector<std::vector<double>>& energies);
+    /* Places a particle on a given site, if any particle is added the random placement of qt particles is skipped */
+    void addParticle(PType type, int site);
+    /* Builds the sites, neighbour lists and particles, called automatically by the run functions */
+    void initialize();
+    /* Runs at most n steps, returns the number of steps done (less if the time limit or the end of all events is reached) */
+    long runSteps(long n);
+    /* Runs until the simulated time reaches "time", returns the number of steps done */
+    long runUntil(double time);
+
+    /* Observables of the run */
+    double getTotalTime() const { return totalTime; }
+    double getOccupation(int site, PType type) const { return siteList[site].getOccupation(type, totalTime); }
+    const std::vector<Site>& getSites() const { return siteList; }
+    const std::vector<Particle>& getParticles() const { return particleList; }
+    const std::array<long, nrOfTransitions>& getTransitionCounts() const { return transitionCounts; }
+    const std::vector<double>& getWaitingTimes() const { return waitingTimes; }
+    const EdgeFlux& getEdgeFlux() const { return edgeFlux; }
+    const Electrodes& getElectrodes() const { return electrodes; }
+    const std::string& getRunID() const { return runID; }
+    EnergyHistogram getOccupationHistogram(PType type, int nrOfBins) const { return OutputManager::computeHistogram(siteList, type, totalTime, nrOfBins); }
+
 
 private:
     RateEngine rate_engine;
     PBC pbc;
     RandomEngine random_engine;
     NextEventList next_event_list {} ;
+    CellList cellList;
 
     /* Storage for the graph and particles */
     std::vector<Site> siteList;
     std::vector<Particle> particleList;
+    ActiveParticleIndex activeParticles; // living particles grouped by type
 
     int nrOfSteps;
     std::string siteFile;
@@ -49,12 +103,105 @@ private:
     double lR_cutOff;
     double sR_cutOff;
     double totalTime = 0.0;
+    double timeLimit = 0.0; // 0 means no limit
+    bool initialized = false;
+    std::vector<std::pair<PType, int>> explicitParticles;
+    std::array<long, nrOfTransitions> transitionCounts{ 0 };
+    std::vector<double> waitingTimes;
+    EdgeFlux edgeFlux;
+    std::string runID; // shared by the output files and the telemetry
+    std::unique_ptr<Telemetry> telemetry; // only exists if the telemetry option is set
+    std::ostream nullStream{ nullptr }; // log() writes here when not verbose, one per run so concurrent runs do not share it
+    Electrodes electrodes; // only enabled with the electrodes option
+    std::vector<int> freeSlots; // IDs of extracted particles, reused by the next injections
     std::array<int,4> nrOfParticlesPerType;
+    RunOptions options;
+    TypeSet typeSet = TypeSet::allTypes; // chosen in initialize() from the initial particles
+    /* Hop rates to the short range neighbours of every site for the carrier of a specialised loop, built on first visit.
+       The rates only depend on the site energies and the field, which do not change during a run. */
+    std::vector<std::vector<double>> carrierHopRates;
+
+    /* Superbasin acceleration, indexed by particle ID */
+    std::vector<Superbasin> superbasins;
+    long superbasinExits = 0;
+    double superbasinHopsSkipped = 0.0;
+
+    /* Long range neighbour lists are built on first use, with lR_cacheSize > 0 at most that many are kept (least recently used are evicted) */
+    std::list<int> lRCache;
+    std::vector<std::list<int>::iterator> lRCachePosition;
+    long lRListsBuilt = 0;
+    long lRCacheEvictions = 0;
+
+    /* Pruning of negligible Forster hops: per site the tail sums of the static rate bounds of the sorted long range neighbours */
+    std::vector<std::vector<double>> lRBoundTail;
+    double prunedRate = 0.0;
+    double prunedRateSum = 0.0;
+    double prunedRelativeSum = 0.0;
+    double prunedRelativeMax = 0.0;
+    long prunedSteps = 0;
 
     /* Helper functions */
+    std::ostream& log();
+    /* Stores the current state in the telemetry counters, if the telemetry is on */
+    void publishTelemetry(long newSteps);
     void initializeSites();
+    /* Replaces the charge energies by correlated (dipolar) disorder with the same mean and width */
+    void applyCorrelatedDisorder();
     void initializeNeighbours();
+    /* Returns the long range neighbours of a site, builds them from the cell list if needed.
+       The reference is valid until the next call (the list can be evicted from the cache). */
+    const std::vector<int>& lRNeighboursOf(int site);
     void initializeParticles();
+    /* Places the particles on free sites drawn from the Boltzmann distribution of their energies at kBT */
+    void initializeParticlesEquilibrium();
+    /* Opens the x boundaries to the electrodes, after the particles are placed */
+    void initializeElectrodes();
+    /* Restarts the clock at zero and clears the occupations and counters, used after the warm-up */
+    void resetStatistics();
     void computeNextEventRates();
-    void executeNextEvent();
+    void executeEvent(Transition transition, int partID, int newLocation);
+    /* Serial event loop for the particle types in Types, from step up to n, returns the step it stopped at.
+       Plain loops are compiled without superbasins, electrodes, edge flux, waiting times and telemetry. */
+    template <TypeSet Types, bool Plain>
+    long runEventLoop(long step, long n);
+    /* Event loop parts for runs with only one carrier type: a neighbour is free or taken by the same type */
+    template <PType carrier, bool Plain>
+    void computeCarrierEventRates();
+    const std::vector<double>& carrierHopRatesOf(int site, PType carrier);
+    /* Returns false if the next event falls at or beyond endTime */
+    template <TypeSet Types, bool Plain>
+    bool executeNextEvent(double endTime);
+    template <bool Plain = false>
+    void hopParticle(int partID, int newLocation);
+    /* Injection events of both electrodes and the extraction events of all carriers in their range */
+    void pushElectrodeEvents();
+    void injectParticle(int side);
+    void extractParticle(int partID, int side);
+    void pushPrunedForsterEvents(int partID, double localRate);
+
+    /* Advances all carriers independently for at most maxSteps or until they interact, returns the number of steps done */
+    long runDilute(long maxSteps);
+    bool diluteFinished = false; // set when the carriers can no longer be treated independently
+    std::vector<RandomEngine> diluteStreams; // one per particle, kept between calls
+    long diluteInteractingEpochs = 0;
+
+    /* Executes the hops of a single carrier type in batches of non-interfering events, for at most maxSteps, returns the number of steps done */
+    long runBatched(long maxSteps);
+    bool batchFinished = false; // set when the run does not consist of a single carrier type
+    std::vector<RandomEngine> batchStreams; // one per particle, kept between calls
+    long batchCount = 0;
+    long batchEvents = 0;
+    long batchRollbacks = 0;
+    long batchInserted = 0; // redrawn hops that were added to their batch
+
+    /* Worker threads of the batch and dilute modes, started on first use and kept until the run is destroyed */
+    std::unique_ptr<WorkerPool> workerPool;
+    WorkerPool& getWorkerPool(unsigned int nrOfThreads);
+
+    /* Superbasin helper functions */
+    void recordCarrierHop(int partID);
+    bool pushSuperbasinEvents(int partID);
+    /* Spreads the time spent in the basin so far over its sites, and dissolves the basin if asked */
+    void settleSuperbasin(int partID, bool dissolve = true);
+    void executeSuperbasinExit(int partID, int exitID);
 };
\ No newline at end of file
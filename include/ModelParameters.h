@@ -0,0 +1,45 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * ModelParameters holds all parameters of a run, it
+ * can be filled in memory or read from the model
+ * parameter file.
+ *
+ **************************************************/
+#pragma once
+#include <array>
+#include <string>
+#include <istream>
+#include "RunOptions.h"
+
+struct ModelParameters {
+    int SEED = 0;
+    int nrOfSteps = 0;
+    double sR_CutOff = 0.0;
+    double lR_CutOff = 0.0;
+    double Xmax = 0.0;
+    double Ymax = 0.0;
+    double Zmax = 0.0;
+    std::array<int, 4> qt{ 0 };
+    std::array<double, 4> DOS_mu{ 0 };
+    std::array<double, 4> DOS_sigma{ 0 };
+    std::array<double, 4> charge{ 0 };
+    std::array<double, 4> v0{ 0 };
+    std::array<double, 4> alpha{ 0 };
+    double kBT = 0.0;
+    double E_Field = 0.0;
+    RunOptions options;
+
+    /* Reads the "key value" pairs of a parameter file like input/modelParameters.txt, returns false if the file cannot be opened.
+       Throws std::invalid_argument for an unknown key or an invalid value. */
+    bool readFromFile(const std::string& fileName);
+    void read(std::istream& in);
+    /* Sets a parameter or option by its name in the parameter file (e.g. "E_Field" or "elec_qt"), returns false if the key is unknown.
+       Throws std::invalid_argument if the value cannot be parsed. */
+    bool set(const std::string& key, const std::string& value);
+};
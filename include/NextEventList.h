@@ -9,7 +9,7 @@
  * Class to store all data concerning next events
  * Also computes the next event.
  **************************************************/
-
+#pragma once
 #include <vector>
 #include <tuple>
 #include <cmath>
@@ -33,6 +33,7 @@ public:
     std::tuple<Transition, int, int> getNextEvent(double random01) const;
 
     int size() { return rateList.size(); }
+    void setVerbose(bool verb) { verbose = verb; }
 
 private:
     int maxSize = 10;
@@ -42,5 +43,6 @@ private:
     std::vector<int> newLocation;
     std::vector<Transition> eventType;
     double totalRate = 0.0;
+    bool verbose = true;
     void resizeVectors();
 };
\ No newline at end of file
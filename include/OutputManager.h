@@ -16,18 +16,49 @@
 #include <vector>
 #include "Site.h"
 #include "Particle.h"
+#include "EnumNames.h"
+#include "EdgeFlux.h"
 #include <fstream>
 
+/* Occupation versus energy for one particle type, bin b covers [eMin + b*binWidth, eMin + (b+1)*binWidth) */
+struct EnergyHistogram {
+	double eMin = 0.0;
+	double binWidth = 0.0;
+	std::vector<long> nrOfSites; // the sampled density of states
+	std::vector<double> occupation; // time averaged number of particles in the bin
+};
+
 class OutputManager {
 public:
+	/* All files of one run share the run ID in their name, an empty ID generates a unique one */
+	OutputManager(std::string runID = "", int seed = 0);
+
 	/* Outputs a file with the site occupations and energies (ln: energy occ).*/
-	void printSiteOccupations(std::vector<Site>& siteList, double totalTime);
+	void printSiteOccupations(const std::vector<Site>& siteList, double totalTime);
+
+	/* Outputs the coordinates, energies and occupations of all sites as binary columns of doubles,
+	   preceded by a text header that names the columns (see the .cpp file for the layout) */
+	void writeSiteOccupationsBinary(const std::vector<Site>& siteList, double totalTime);
+
+	/* Outputs the occupation versus energy histograms of all particle types */
+	void printOccupationHistograms(const std::vector<Site>& siteList, double totalTime, int nrOfBins);
+
+	/* Outputs the net number of hops between all pairs of sites that have one (ln: type from to net) */
+	void printNetFlux(const EdgeFlux& edgeFlux, const std::vector<Site>& siteList);
 
 	/* Prints the current state of all particles to the console */
 	void printParticleInfo(std::vector<Particle>&);
 
+	static EnergyHistogram computeHistogram(const std::vector<Site>& siteList, PType type, double totalTime, int nrOfBins);
+
+	const std::string& getRunID() const { return runID; }
+	void setVerbose(bool verb) { verbose = verb; }
 
 private:
 	std::string outputPath = "./output/";
+	std::string runID;
+	bool verbose = true;
 
-};
\ No newline at end of file
+	/* Opens outputPath + name, creates the output directory if needed */
+	bool openFile(std::ofstream& outFile, const std::string& filename, std::ios_base::openmode mode = std::ios_base::out);
+};
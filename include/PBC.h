@@ -8,12 +8,13 @@
  *
  * PBC stores and computes all things relating to 
  * the periodic boundary conditions (PBC).
+ * The x direction can be made open (for runs with
+ * electrodes), y and z are always periodic.
  *
  **************************************************/
 
 #pragma once
 #include <Eigen/Dense>
-#include "Site.h"
 
 class PBC {
 public:
@@ -22,8 +23,8 @@ public:
 
     /* Computes the 3vector dr pointing from v to w corrected for periodic boundary conditions. */
     Eigen::Vector3d dr_PBC_corrected(const Eigen::Vector3d& v, const Eigen::Vector3d& w) const {\
-        static Eigen::Vector3d res;
-        res[0] = w[0] - v[0] - std::floor((w[0] - v[0]) / boxDimension[0] + 0.5) * boxDimension[0];
+        Eigen::Vector3d res;
+        res[0] = periodicX ? w[0] - v[0] - std::floor((w[0] - v[0]) / boxDimension[0] + 0.5) * boxDimension[0] : w[0] - v[0];
         res[1] = w[1] - v[1] - std::floor((w[1] - v[1]) / boxDimension[1] + 0.5) * boxDimension[1];
         res[2] = w[2] - v[2] - std::floor((w[2] - v[2]) / boxDimension[2] + 0.5) * boxDimension[2];
         return res;
@@ -33,6 +34,11 @@ public:
     Eigen::Vector3d updatePostionPBC(const Eigen::Vector3d& v) const {
         return v.array() - floor(v.array() / boxDimension.array()) * boxDimension.array();
     }
+    const Eigen::Vector3d& getBoxDimension() const { return boxDimension; }
+    /* With an open x direction nothing interacts through the x = 0 / x = xDim faces */
+    void setPeriodicX(bool periodic) { periodicX = periodic; }
+    bool isPeriodicX() const { return periodicX; }
 private:
     Eigen::Vector3d boxDimension;
+    bool periodicX = true;
 };
\ No newline at end of file
@@ -18,7 +18,7 @@
 
 class Particle {
 public:
-	Particle(int loc, PType type) : location{ loc }, type{ type }, energyLevel{ 0 } {};
+	Particle(int loc, PType type) : location{ loc }, type{ type }, energyLevel{ 0 }, dr_travelled{ Eigen::Vector3d::Zero() } {};
 	
 	PType getType() const { return type; }
 	/* Creates an exciton with 3:1 ratio for trip vs sing states */
@@ -35,6 +35,8 @@ public:
 	bool isAlive() const { return alive; }
 
 	double distanceTravelled() const { return dr_travelled.norm(); }
+	/* Starts measuring the displacement again from the current location */
+	void resetDisplacement() { dr_travelled.setZero(); }
 	int getLocation() const { return location; }
 	int getLocationCTelec() const { return locationCTelec; }
 
@@ -19,15 +19,22 @@
 
 class RandomEngine {
 public:
-    RandomEngine(int seed) { rng = std::mt19937_64(seed); }
+    RandomEngine(int seed) : seed(seed) { rng = std::mt19937_64(seed); }
+    RandomEngine(int seed, std::array<double, 4> mu, std::array<double, 4> sigma) : RandomEngine(seed) { initializeParameters(mu, sigma); }
+    /* Creates an independent random stream, e.g. for one particle or thread, with the same DOS parameters */
+    RandomEngine makeStream(int streamID) const;
     void initializeParameters(std::array<double, 4> mu, std::array<double, 4> sigma);
     void setNrOfSites(int nr) { siteDist = std::uniform_int_distribution<int>(0,nr-1); }
     double getDOSEnergy(PType type) { return dos[type](rng); }
+    double getDOSMean(PType type) const { return dos[type].mean(); }
+    double getDOSSigma(PType type) const { return dos[type].stddev(); }
     double getUniform01() { return uniform01(rng); }
     int getRandomSite() { return siteDist(rng); }
     double getInterArrivalTime(double rate) { return -(1.0 / rate) * log(uniform01(rng)); }
+    int getSeed() const { return seed; }
 
 private:
+    int seed;
     std::mt19937_64 rng;
     std::array<std::normal_distribution<double>, 4> dos;
     std::uniform_real_distribution<double> uniform01 { 0.0, 1.0 };
@@ -13,14 +13,16 @@
 
 #pragma once
 #include <array>
+#include <cmath>
 #include "Site.h"
 #include "Particle.h"
 #include "PBC.h"
 #include "EnumNames.h"
+#include "FastMath.h"
 
 class RateEngine {
 public:
-    RateEngine(std::array<double, 4> v0, std::array<double, 4> alpha, std::array<double, 4> charge, double E_Field, double kBT, PBC& pbc) : 
+    RateEngine(std::array<double, 4> v0, std::array<double, 4> alpha, std::array<double, 4> charge, double E_Field, double kBT, const PBC& pbc) : 
         v0(v0), alpha(alpha), charge(charge), E_Field(E_Field), kBT(kBT), pbc(pbc) {};
     double millerAbrahams(const Site& siteOne, const Site& siteTwo, const PType type) const;
     double millerAbrahamsCT(const Site& siteOne, const Site& siteTwo, const PType type) const;
@@ -28,8 +30,27 @@ public:
     double millerAbrahamsDIS(const Site& siteOne, const Site& siteTwo, const PType type) const;
     double millerAbrahamsCT_DIS(const Site& siteOne, const Site& siteTwo, const PType type) const;
     double forster(const Site& siteOne, const Site& siteTwo) const;
+    /* Upper bound of the Forster rate over a distance dist, reached for a downhill hop */
+    double forsterUpperBound(double dist) const { return v0[PType::sing] * forsterFactor(dist); }
     double decay(const PType type) const;
 
+    /* The geometric and field parts of millerAbrahams(), for engines that precompute them per hop of a fixed geometry.
+       dx is the x component of the vector pointing from the target to the origin site. */
+    double millerAbrahamsPrefactor(double dist, const PType type) const { return v0[type] * exponential(-2 * alpha[type] * dist); }
+    double fieldEnergy(double dx, const PType type) const { return E_Field * charge[type] * dx; }
+    /* Miller-Abrahams rate of a hop over a distance dist with an energy difference deltaE (field included), e.g. to or from an electrode */
+    double millerAbrahams(double dist, double deltaE, const PType type) const {
+        return deltaE <= 0 ? millerAbrahamsPrefactor(dist, type) : v0[type] * exponential(-2 * alpha[type] * dist - deltaE / kBT);
+    }
+    double getkBT() const { return kBT; }
+
+    /* Fast math mode: the exponentials use FastMath::exp (relative error < FastMath::maxExpError) and
+       (R/dist)^6 is computed by multiplication */
+    void setFastMath(bool fast) { fastMath = fast; }
+    bool getFastMath() const { return fastMath; }
+    /* Open x boundaries, see PBC::setPeriodicX */
+    void setPeriodicX(bool periodic) { pbc.setPeriodicX(periodic); }
+
 
 private:
     std::array<double, 4> v0;
@@ -44,6 +65,8 @@ private:
     double kBT;
     double R_forster = 0.3;
     PBC pbc;
+    bool fastMath = false;
 
-
+    double exponential(double x) const { return fastMath ? FastMath::exp(x) : std::exp(x); }
+    double forsterFactor(double dist) const { return fastMath ? FastMath::pow6(R_forster / dist) : std::pow(R_forster / dist, 6); }
 };
\ No newline at end of file
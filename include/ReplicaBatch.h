@@ -0,0 +1,91 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * ReplicaBatch advances a fixed number of replicas
+ * (lanes) of a single carrier type in lockstep on the
+ * same geometry. Every lane has its own energies,
+ * carriers, clock and random stream. The state of
+ * all lanes is interleaved (one Eigen array per site
+ * or carrier), so the rates and the selection of the
+ * next event are computed for all lanes at once.
+ *
+ **************************************************/
+#pragma once
+#include <vector>
+#include <array>
+#include <Eigen/Dense>
+#include "ModelParameters.h"
+#include "RateEngine.h"
+#include "RandomEngine.h"
+#include "PBC.h"
+#include "EnumNames.h"
+
+template <int Lanes>
+class ReplicaBatch {
+public:
+    using LaneDouble = Eigen::Array<double, Lanes, 1>;
+    using LaneInt = Eigen::Array<int, Lanes, 1>;
+
+    /* Lane l is seeded with stream firstReplica + l of params.SEED and holds params.qt[type] carriers,
+       type must be PType::elec or PType::hole. */
+    ReplicaBatch(const ModelParameters& params, const std::vector<Eigen::Vector3d>& coordinates, PType type, int firstReplica = 0);
+
+    /* Every lane performs n hops, or less if it reaches the time limit, returns the number of lockstep steps */
+    long runSteps(long n);
+    /* Runs all lanes until their clocks reach "time", returns the number of lockstep steps */
+    long runUntil(double time);
+
+    static constexpr int getNrOfLanes() { return Lanes; }
+    int getNrOfSites() const { return energy.size(); }
+    int getNrOfCarriers() const { return location.size(); }
+    double getTotalTime(int lane) const { return clock[lane]; }
+    long getNrOfHops(int lane) const { return hops[lane]; }
+    double getEnergy(int site, int lane) const { return energy[site][lane]; }
+    int getLocation(int carrier, int lane) const { return location[carrier][lane]; }
+    /* Time integrated occupation of a site in one lane */
+    double getOccupation(int site, int lane) const;
+    /* Sum of all hop vectors of the carriers in one lane */
+    Eigen::Vector3d getDisplacement(int lane) const { return displacement[lane]; }
+
+private:
+    RateEngine rate_engine;
+    PBC pbc;
+    PType type;
+    double timeLimit = 0.0; // 0 means no limit
+    std::vector<RandomEngine> streams; // one per lane
+    std::array<bool, Lanes> finished{ false }; // lanes that reached the time limit or have no events left
+
+    /* Shared geometry, the hops from site s are the edges edgeOffset[s] up to edgeOffset[s + 1] */
+    std::vector<int> edgeOffset;
+    std::vector<int> edgeTarget;
+    std::vector<double> edgePrefactor;
+    std::vector<double> edgeField;
+    std::vector<Eigen::Vector3d> edgeDr;
+
+    /* State of all lanes, site or carrier major */
+    std::vector<LaneDouble> energy;
+    std::vector<LaneDouble> vacant; // 1.0 if the site is free in a lane, multiplies the rate
+    std::vector<LaneInt> carrierAt; // carrier on a site in a lane, -1 if none
+    std::vector<LaneDouble> occupation;
+    std::vector<LaneInt> location;
+    std::vector<LaneDouble> occupiedSince;
+    LaneDouble clock = LaneDouble::Zero();
+    Eigen::Array<long, Lanes, 1> hops = Eigen::Array<long, Lanes, 1>::Zero();
+    std::array<Eigen::Vector3d, Lanes> displacement;
+
+    /* Hop rates per carrier (slot k is the k-th edge of its site in a lane), only recomputed for a carrier
+       when a hop in one of the lanes changed its surroundings */
+    std::vector<std::vector<LaneDouble>> carrierRates;
+    std::vector<LaneDouble> carrierTotal;
+    std::vector<char> dirty;
+
+    void computeCarrierRates(int carrier);
+
+    /* Performs one event in every lane that is not finished, returns false if all lanes are finished */
+    bool step();
+};
@@ -0,0 +1,105 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * RunOptions stores the optional settings of a run.
+ * They are read as "key value" pairs after the
+ * fixed model parameters, every option has a
+ * default so older parameter files keep working.
+ *
+ **************************************************/
+#pragma once
+#include <string>
+
+struct RunOptions {
+    /* Superbasin acceleration: replaces the bouncing of a carrier inside a small set of
+       sites by a single exit event drawn from the absorbing Markov chain of that set. */
+    bool superbasin = false;
+    int superbasin_history = 16; // number of recent hops inspected for a basin
+    int superbasin_maxSites = 4; // maximum number of distinct sites in a basin
+
+    /* Dilute mode: every charge carrier is advanced independently on its own thread, with its own
+       clock and random stream, synchronised at the end of every epoch. */
+    bool dilute = false;
+    bool dilute_fallback = true; // continue serially when two carriers come within interaction range
+    int dilute_epochSteps = 50; // average number of hops per carrier in one epoch
+    int dilute_threads = 0; // 0 means one thread per hardware core
+
+    /* Batch mode (runs with a single carrier type): the events of a short time window whose hops have disjoint
+       neighbourhoods are executed together on several threads, hops that were overtaken by a redrawn clock are rolled back. */
+    bool batch = false;
+    double batch_window = 64; // expected number of events in one time window
+    int batch_threads = 0; // 0 means one thread per hardware core
+
+    /* Forster hops of a singlet are dropped once the static bound of all remaining (further) hops
+       is below this fraction of the singlet's total rate so far, 0 disables the pruning. */
+    double lR_pruneFraction = 0.0;
+
+    /* Long range (Forster) neighbour lists are built the first time a singlet visits a site. With a
+       cache size > 0 only that many lists are kept, the least recently used ones are dropped. */
+    int lR_cacheSize = 0;
+
+    /* Counts the hops over every pair of sites and writes the net current map: "none", "dense" (counters
+       aligned with the short range lists), "sparse" (hash map) or "auto" (sparse until most edges are used) */
+    std::string edge_flux = "none";
+
+    /* Periodically writes throughput, simulated time, total rate, event list length, populations and the
+       estimated time to completion as JSON lines to a file or a Unix socket ("unix:<path>"), empty is off */
+    std::string telemetry = "";
+    double telemetry_interval = 1.0; // seconds between two samples
+
+    /* Energetic disorder of the charges: "gaussian" (independent per site) or "dipolar" (correlated, from randomly
+       oriented dipoles on all sites, scaled to the DOS mean and width). Excitons always use the gaussian DOS. */
+    std::string disorder = "gaussian";
+    double disorder_cutOff = 0.0; // cut-off of the dipole sum, 0 means three times the mean site spacing
+    int disorder_threads = 0; // 0 means one thread per hardware core
+
+    /* Initial positions of the particles: "uniform" (random free sites) or "equilibrium" (free sites drawn
+       without replacement with Boltzmann weights exp(-E/kBT) of their own site energies) */
+    std::string initial_placement = "uniform";
+    /* Steps run before the actual run, after which the clock, the occupations and the counters start again from zero */
+    long warmup_steps = 0;
+
+    /* Runs with only electrons or only holes use an event loop compiled for that carrier alone (same results, less branches) */
+    bool specialize_types = true;
+
+    /* Fast math rate mode (see RateEngine::setFastMath), on by default in builds with -DKMC_FAST_MATH=ON */
+#ifdef KMC_FAST_MATH
+    bool fast_math = true;
+#else
+    bool fast_math = false;
+#endif
+
+    /* Open system: the x direction is open (y and z stay periodic) with an electrode at x = 0 (left) and at x = Xmax
+       (right). Both inject carriers of electrode_carrier into the free sites within electrode_range and extract them
+       again, with Miller-Abrahams rates to and from an electrode level that lies the injection barrier below the DOS
+       mean. Only the electrode carrier can be present, otherwise KmcRun throws std::invalid_argument. The slots of
+       extracted particles are reused. */
+    bool electrodes = false;
+    std::string electrode_carrier = "auto"; // "elec", "hole" or "auto" (the type of the initial particles, electrons if there are none)
+    double electrode_range = 0.0; // largest distance (along x) of a site to the electrode, 0 means sR_CutOff
+    double electrode_barrierLeft = 0.3; // injection barrier of the left electrode
+    double electrode_barrierRight = 0.3; // injection barrier of the right electrode
+
+    /* Stops the run when this simulated time is reached, 0 means the run is only limited by nrOfSteps */
+    double max_time = 0.0;
+    /* Reports progress and results on the console */
+    bool verbose = true;
+    /* Writes the output files at the end of the run, into ./output/ */
+    bool write_output = true;
+    /* Format of the per site occupation file: "text", "binary" (columnar float64 with a text header) or "none" */
+    std::string output_format = "text";
+    /* Writes the occupation versus energy histograms of every particle type, with this many bins (0 disables) */
+    int output_histogramBins = 0;
+    /* Name shared by all output files of the run, empty generates a unique one from the time, seed and a random tag */
+    std::string run_id = "";
+    /* Stores every waiting time of the serial event loop (for testing, grows with the number of steps) */
+    bool record_waitingTimes = false;
+
+    /* Sets the option "key" to "value", returns false if the key is unknown. Throws std::invalid_argument for an unknown value of a named choice. */
+    bool set(const std::string& key, const std::string& value);
+};
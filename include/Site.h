@@ -23,10 +23,14 @@ class Site {
 public:
 	Site(Eigen::Vector3d coord, std::vector<double> energies);
 	double getEnergy(PType pType) const { return energies[pType]; }
+	void setEnergy(PType pType, double energy) { energies[pType] = energy; }
 	Eigen::Vector3d getCoordinates() const { return coord; }
 
 	void addSRNeighbour(int nb) { sRNeighbours.push_back(nb); }
 	void addLRNeighbour(int nb) { lRNeighbours.push_back(nb); }
+	void setLRNeighbours(std::vector<int> nbs) { lRNeighbours = std::move(nbs); lRBuilt = true; }
+	void clearLRNeighbours() { std::vector<int>().swap(lRNeighbours); lRBuilt = false; }
+	bool hasLRNeighbours() const { return lRBuilt; }
 	bool isOccupied(PType type) const { return occupied[type]; }
 	int isOccupiedBy(PType type) const;
 
@@ -35,7 +39,11 @@ public:
 	/* Change the current occupation to another type of occupation */
 	void changeOccupied(PType oldType, PType newType, int partID, double totalTime) { occupied[oldType] = false; occupied[newType] = true; startOccupation[newType] = totalTime; occupiedBy[newType] = partID; }
 	void freeSite(PType type, double totalTime) { if(occupied[type]){ occupied[type] = false;} else{std::cout << "Attempt to free a non occupied site." << std::endl;} totalOccupation[type] += (totalTime - startOccupation[type]); }
-	double getOccupation(PType type, double totalTime) { return occupied[type] ? totalOccupation[type] += (totalTime - startOccupation[type]) : totalOccupation[type]; }
+	/* Adds occupation time that was not accounted for by setOccupied()/freeSite(), dt can be negative */
+	void addOccupation(PType type, double dt) { totalOccupation[type] += dt; }
+	/* Forgets all occupation time, for a clock that restarts at zero */
+	void resetOccupation() { startOccupation.fill(0.0); totalOccupation.fill(0.0); }
+	double getOccupation(PType type, double totalTime) const { return occupied[type] ? totalOccupation[type] + (totalTime - startOccupation[type]) : totalOccupation[type]; }
 	const std::vector<int>& getSRNeighbours() const { return sRNeighbours; }
 	const std::vector<int>& getLRNeighbours() const { return lRNeighbours; }
 
@@ -44,6 +52,7 @@ private:
 	Eigen::Vector3d coord;
 	std::vector<int> sRNeighbours; // sR = short Range
 	std::vector<int> lRNeighbours; // lR = long Range (for Forster transport)
+	bool lRBuilt = false;
 	std::array<bool, 5> occupied {false};
 	std::array<int, 5> occupiedBy{ 0 };
 	static PBC pbc;
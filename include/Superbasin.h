@@ -0,0 +1,59 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * Class to store the superbasin of a single carrier.
+ * It keeps the recent hop history of the carrier,
+ * detects small sets of sites the carrier keeps
+ * bouncing between and stores the exit events of
+ * such a basin.
+ **************************************************/
+#pragma once
+#include <vector>
+#include "EnumNames.h"
+
+class Superbasin {
+public:
+    /* A single way out of the basin: a transition from basin site "source" to "target" */
+    struct Exit {
+        int source;
+        int target;
+        Transition type;
+        double rate;
+    };
+
+    /* Stores a hop to "site" in the ring buffer of the last "historyLength" hops */
+    void recordHop(int site, int historyLength);
+    /* Returns true and activates the basin if a full history visits at most "maxSites" distinct sites */
+    bool detect(int maxSites, int historyLength, int entrySite, double time);
+    /* Deactivates the basin and clears the hop history */
+    void clear() { active = false; history.clear(); histPos = 0; basinSites.clear(); exits.clear(); }
+
+    /* Restarts the basin clock after the time so far has been accounted for */
+    void restartClock(double time) { entryTime = time; }
+    bool isActive() const { return active; }
+    int getEntrySite() const { return entrySite; }
+    double getEntryTime() const { return entryTime; }
+    int getNrOfSites() const { return basinSites.size(); }
+    int getSite(int j) const { return basinSites[j]; }
+    /* Returns the index of site in the basin or -1 if it is not part of the basin */
+    int indexOf(int site) const;
+
+    /* Expected fraction of the escape time spent on each basin site */
+    std::vector<double> residence;
+    std::vector<Exit> exits;
+    /* Expected number of internal hops per escape, only used for reporting */
+    double internalHopsPerExit = 0.0;
+
+private:
+    std::vector<int> history;
+    int histPos = 0;
+    bool active = false;
+    int entrySite = 0;
+    double entryTime = 0.0;
+    std::vector<int> basinSites;
+};
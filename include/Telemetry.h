@@ -0,0 +1,75 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * Telemetry of a running simulation. The event loop
+ * only stores counters in relaxed atomics, a
+ * background thread samples them periodically and
+ * writes one JSON line per sample to a file or to a
+ * Unix domain socket ("unix:<path>").
+ *
+ **************************************************/
+#pragma once
+#include <string>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include "EnumNames.h"
+
+class Telemetry {
+public:
+    Telemetry(std::string target, double interval, std::string runID);
+    /* Writes a last sample and stops the background thread */
+    ~Telemetry();
+
+    /* Used to estimate the time to completion, 0 means no target */
+    void setTarget(long steps, double time) { targetSteps.store(steps, std::memory_order_relaxed); targetTime.store(time, std::memory_order_relaxed); }
+
+    /* Called from the event loop, the only writer, so a relaxed load and store do (no locked read-modify-write per event) */
+    void addSteps(long n) { steps.store(steps.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    void setState(double time, double rate, long nrOfEvents) {
+        simulatedTime.store(time, std::memory_order_relaxed);
+        totalRate.store(rate, std::memory_order_relaxed);
+        eventListLength.store(nrOfEvents, std::memory_order_relaxed);
+    }
+    void setPopulation(PType type, int n) { population[type].store(n, std::memory_order_relaxed); }
+    /* Counts the steps from zero again (after a warm-up), the progress estimate restarts with them */
+    void restartSteps();
+
+private:
+    std::string target;
+    std::chrono::duration<double> interval;
+    std::string runID;
+    std::chrono::steady_clock::time_point startTime;
+
+    std::atomic<long> steps{ 0 };
+    std::atomic<double> restartWallTime{ 0.0 }; // wall time of the last restartSteps(), seconds since the start
+    std::atomic<double> simulatedTime{ 0.0 };
+    std::atomic<double> totalRate{ 0.0 };
+    std::atomic<long> eventListLength{ 0 };
+    std::array<std::atomic<int>, 5> population{};
+    std::atomic<long> targetSteps{ 0 };
+    std::atomic<double> targetTime{ 0.0 };
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    std::ofstream file;
+    int socketFd = -1;
+    std::string socketPath;
+
+    void run();
+    std::string sample(long& lastSteps, std::chrono::steady_clock::time_point& lastTime);
+    bool connectSocket();
+    void write(const std::string& line);
+};
@@ -0,0 +1,47 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * Fixed set of worker threads that are started once
+ * and sleep between jobs, for the small parallel
+ * loops of the batch and dilute modes. Starting
+ * threads for every loop costs more than the loop.
+ *
+ **************************************************/
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class WorkerPool {
+public:
+    /* nrOfThreads includes the calling thread, so one thread starts no workers */
+    explicit WorkerPool(unsigned int nrOfThreads);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned int getNrOfThreads() const { return workers.size() + 1; }
+    /* Runs work(i) for 0 <= i < count on the workers and the calling thread, returns when all are done */
+    void run(int count, const std::function<void(int)>& work);
+
+private:
+    void workerLoop(unsigned int id);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    unsigned int jobThreads = 0; // threads taking part in the current job, the calling thread included
+    long generation = 0; // counts the jobs, a worker runs each one once
+    unsigned int busy = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,325 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * MPI driver for ensembles and parameter sweeps.
+ * Rank 0 reads the input and broadcasts it (the site
+ * geometry only once), then hands out the runs one
+ * at a time to the workers that ask for one. The
+ * results are reduced to rank 0 which writes the
+ * output. They do not depend on the number of ranks
+ * or on which rank ran which replica.
+ *
+ * A sweep file has one parameter point per line, as
+ * "key value" pairs that override the parameter file
+ * (e.g. "E_Field 0.01 kBT 0.02"). Without a sweep
+ * file the parameter file is the only point. Replica
+ * r of a point uses SEED + r.
+ *
+ * Usage: mpirun -np <ranks> KMC_mpi [nrOfReplicas] [sweepFile] [paramFile] [siteFile] [outputPath]
+ **************************************************/
+
+#include <mpi.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <filesystem>
+#include <boost/format.hpp>
+#include "KmcRun.h"
+#include "ModelParameters.h"
+#include "OutputManager.h"
+
+namespace {
+
+const int tagRequest = 1;
+const int tagTask = 2;
+const int noTask = -1;
+
+const char* transitionNames[] = { "normalhop", "decay", "excitonFromElec", "excitonFromHole", "excitonFromElecCT", "excitonFromHoleCT",
+	"singToCTViaElec", "singToCTViaHole", "tripToCTViaElec", "tripToCTViaHole", "CTdisViaHole", "CTdisViaElec", "superbasinExit",
+	"injection", "extraction" };
+const char* typeNames[] = { "elec", "hole", "trip", "sing", "CT" };
+
+/* Layout of the counters of one point (summed over its replicas) */
+const int cntTime = 0;
+const int cntSteps = 1;
+const int cntTransitions = 2;
+const int cntAlive = cntTransitions + nrOfTransitions;
+const int cntDead = cntAlive + 5;
+const int nrOfCounters = cntDead + 5;
+
+/* Occupations are summed in fixed point, integer sums are exact in any order (up to 2^15 replicas per point) */
+const double occupationScale = 281474976710656.0; // 2^48
+
+void broadcastString(std::string& str, int rank) {
+	long size = str.size();
+	MPI_Bcast(&size, 1, MPI_LONG, 0, MPI_COMM_WORLD);
+	if (rank != 0) {
+		str.resize(size);
+	}
+	MPI_Bcast(&str[0], size, MPI_CHAR, 0, MPI_COMM_WORLD);
+}
+
+std::string readFile(const std::string& fileName) {
+	std::ifstream file(fileName);
+	if (!file.is_open()) {
+		std::cout << "Unable to open file: " << fileName << std::endl;
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	return buffer.str();
+}
+
+struct Ensemble {
+	std::vector<ModelParameters> points;
+	std::vector<std::string> pointNames; // the overrides of every point
+	std::vector<Eigen::Vector3d> coordinates;
+	int nrOfReplicas = 1;
+
+	/* Sums over the replicas of every point, occupation is point, site and type major */
+	std::vector<int64_t> occupation;
+	std::vector<double> counters;
+	/* Counters of every task, summed per point in task order once all ranks are done */
+	std::vector<double> taskCounters;
+
+	int nrOfTasks() const { return points.size() * nrOfReplicas; }
+
+	void runTask(int task) {
+		int point = task / nrOfReplicas;
+		int replica = task % nrOfReplicas;
+		ModelParameters params = points[point];
+		params.SEED += replica;
+		params.options.verbose = false;
+		params.options.write_output = false;
+		params.options.telemetry = "";
+
+		KmcRun run{ params };
+		run.setSites(coordinates);
+		long steps = run.runSteps(params.nrOfSteps);
+
+		double totalTime = run.getTotalTime();
+		int nrOfSites = coordinates.size();
+		int64_t* occ = &occupation[(long)point * nrOfSites * 4];
+		if (totalTime > 0.0) {
+			for (int s = 0; s < nrOfSites; ++s) {
+				for (int t = 0; t < 4; ++t) {
+					occ[s * 4 + t] += std::llround(run.getOccupation(s, PType(t)) / totalTime * occupationScale);
+				}
+			}
+		}
+		double* cnt = &taskCounters[(long)task * nrOfCounters];
+		cnt[cntTime] += totalTime;
+		cnt[cntSteps] += steps;
+		for (int t = 0; t < nrOfTransitions; ++t) {
+			cnt[cntTransitions + t] += run.getTransitionCounts()[t];
+		}
+		for (const auto& part : run.getParticles()) {
+			cnt[(part.isAlive() ? cntAlive : cntDead) + part.getType()] += 1.0;
+		}
+	}
+};
+
+/* Hands out the tasks in order to whichever worker asks first, until all are done */
+void master(int nrOfTasks, int nrOfWorkers, bool verbose) {
+	int next = 0;
+	int activeWorkers = nrOfWorkers;
+	while (activeWorkers > 0) {
+		int done;
+		MPI_Status status;
+		MPI_Recv(&done, 1, MPI_INT, MPI_ANY_SOURCE, tagRequest, MPI_COMM_WORLD, &status);
+		int task = (next < nrOfTasks) ? next++ : noTask;
+		if (task == noTask) {
+			activeWorkers--;
+		}
+		MPI_Send(&task, 1, MPI_INT, status.MPI_SOURCE, tagTask, MPI_COMM_WORLD);
+		if (verbose && task != noTask) {
+			std::cout << "\rDispatched run " << task + 1 << " of " << nrOfTasks << std::flush;
+		}
+	}
+	if (verbose) std::cout << std::endl;
+}
+
+void worker(Ensemble& ensemble) {
+	int done = 0;
+	while (true) {
+		MPI_Send(&done, 1, MPI_INT, 0, tagRequest, MPI_COMM_WORLD);
+		int task;
+		MPI_Recv(&task, 1, MPI_INT, 0, tagTask, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		if (task == noTask) {
+			break;
+		}
+		ensemble.runTask(task);
+		done++;
+	}
+}
+
+void writeResults(const Ensemble& ensemble, std::string outputPath, const std::string& runID) {
+	if (!outputPath.empty() && outputPath.back() != '/') {
+		outputPath += '/';
+	}
+	std::error_code ec;
+	std::filesystem::create_directories(outputPath, ec);
+	int nrOfSites = ensemble.coordinates.size();
+	double replicas = ensemble.nrOfReplicas;
+
+	std::string summaryName = outputPath + "ensemble_" + runID + "_summary.txt";
+	std::ofstream summary(summaryName);
+	summary << "# run_id " << runID << "\n# replicas " << ensemble.nrOfReplicas << "\n# averages per replica\n# point time steps";
+	for (const auto& name : transitionNames) summary << " " << name;
+	for (const auto& name : typeNames) summary << " alive_" << name;
+	for (const auto& name : typeNames) summary << " dead_" << name;
+	summary << "\n";
+
+	for (unsigned int p = 0; p < ensemble.points.size(); ++p) {
+		const double* cnt = &ensemble.counters[p * nrOfCounters];
+		summary << p;
+		for (int c = 0; c < nrOfCounters; ++c) {
+			summary << " " << cnt[c] / replicas;
+		}
+		summary << "\n";
+
+		std::string occName = outputPath + str(boost::format("ensemble_%s_occ_p%d.txt") % runID % p);
+		std::ofstream occFile(occName);
+		occFile << "# point " << p << ": " << ensemble.pointNames[p] << "\n# x y z elec hole trip sing (occupation averaged over " << ensemble.nrOfReplicas << " replicas)\n";
+		const int64_t* occ = &ensemble.occupation[(long)p * nrOfSites * 4];
+		for (int s = 0; s < nrOfSites; ++s) {
+			const Eigen::Vector3d& coord = ensemble.coordinates[s];
+			occFile << coord[0] << " " << coord[1] << " " << coord[2];
+			for (int t = 0; t < 4; ++t) {
+				occFile << " " << occ[s * 4 + t] / occupationScale / replicas;
+			}
+			occFile << "\n";
+		}
+
+		std::cout << boost::format("point %d (%s): mean time %g, mean steps %g, dead per replica") % p % ensemble.pointNames[p] % (cnt[cntTime] / replicas) % (cnt[cntSteps] / replicas);
+		for (int t = 0; t < 5; ++t) {
+			std::cout << " " << cnt[cntDead + t] / replicas;
+		}
+		std::cout << "\n";
+	}
+	std::cout << "Ensemble results were printed to:\n\t" << summaryName << "\n\t" << outputPath << "ensemble_" << runID << "_occ_p*.txt" << std::endl;
+}
+
+}
+
+void runDriver(int argc, char* argv[], int rank, int size) {
+	Ensemble ensemble;
+	ensemble.nrOfReplicas = (argc > 1) ? std::stoi(argv[1]) : 8;
+	std::string sweepFile = (argc > 2) ? argv[2] : "";
+	std::string paramFile = (argc > 3) ? argv[3] : "./input/modelParameters.txt";
+	std::string siteFile = (argc > 4) ? argv[4] : "./input/sites.txt";
+	std::string outputPath = (argc > 5) ? argv[5] : "./output/";
+
+	/* Rank 0 reads all input, the other ranks receive it */
+	std::string paramText, sweepText;
+	std::vector<double> flatCoordinates;
+	if (rank == 0) {
+		paramText = readFile(paramFile);
+		sweepText = sweepFile.empty() ? "" : readFile(sweepFile);
+		std::istringstream sites(readFile(siteFile));
+		double x;
+		while (sites >> x) {
+			flatCoordinates.push_back(x);
+		}
+	}
+	broadcastString(paramText, rank);
+	broadcastString(sweepText, rank);
+	long nrOfValues = flatCoordinates.size();
+	MPI_Bcast(&nrOfValues, 1, MPI_LONG, 0, MPI_COMM_WORLD);
+	flatCoordinates.resize(nrOfValues);
+	MPI_Bcast(flatCoordinates.data(), nrOfValues, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+	for (long i = 0; i + 2 < nrOfValues; i += 3) {
+		ensemble.coordinates.emplace_back(flatCoordinates[i], flatCoordinates[i + 1], flatCoordinates[i + 2]);
+	}
+
+	/* Every rank builds the same parameter points */
+	ModelParameters base;
+	std::istringstream paramStream(paramText);
+	base.read(paramStream);
+	std::istringstream sweepStream(sweepText);
+	std::string line;
+	while (std::getline(sweepStream, line)) {
+		if (line.find_first_not_of(" \t\r") == std::string::npos || line[line.find_first_not_of(" \t")] == '#') {
+			continue;
+		}
+		ModelParameters point = base;
+		std::istringstream pairs(line);
+		std::string key, value;
+		while (pairs >> key >> value) {
+			if (!point.set(key, value)) {
+				if (rank == 0) std::cout << "Invalid sweep point: " << line << std::endl;
+				MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+			}
+		}
+		ensemble.points.push_back(point);
+		ensemble.pointNames.push_back(line);
+	}
+	if (ensemble.points.empty()) {
+		ensemble.points.push_back(base);
+		ensemble.pointNames.push_back("parameter file");
+	}
+	ensemble.occupation.assign(ensemble.points.size() * ensemble.coordinates.size() * 4, 0);
+	ensemble.counters.assign(ensemble.points.size() * nrOfCounters, 0.0);
+	ensemble.taskCounters.assign((long)ensemble.nrOfTasks() * nrOfCounters, 0.0);
+
+	if (rank == 0) {
+		std::cout << size << " ranks, " << ensemble.points.size() << " parameter points of " << ensemble.nrOfReplicas << " replicas, "
+			<< ensemble.coordinates.size() << " sites" << std::endl;
+	}
+	double begin = MPI_Wtime();
+	if (size == 1) {
+		for (int task = 0; task < ensemble.nrOfTasks(); ++task) {
+			ensemble.runTask(task);
+		}
+	}
+	else if (rank == 0) {
+		master(ensemble.nrOfTasks(), size - 1, base.options.verbose);
+	}
+	else {
+		worker(ensemble);
+	}
+
+	/* Sum of all ranks on rank 0 (the master contributes zeros). Every task was run by one rank only,
+	   so its counters are exact after the reduction and are summed per point in the same order for any number of ranks. */
+	MPI_Reduce(rank == 0 ? MPI_IN_PLACE : ensemble.occupation.data(), ensemble.occupation.data(), ensemble.occupation.size(), MPI_INT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+	MPI_Reduce(rank == 0 ? MPI_IN_PLACE : ensemble.taskCounters.data(), ensemble.taskCounters.data(), ensemble.taskCounters.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+	if (rank == 0) {
+		for (int task = 0; task < ensemble.nrOfTasks(); ++task) {
+			int point = task / ensemble.nrOfReplicas;
+			for (int c = 0; c < nrOfCounters; ++c) {
+				ensemble.counters[point * nrOfCounters + c] += ensemble.taskCounters[(long)task * nrOfCounters + c];
+			}
+		}
+		std::cout << "Ensemble done in " << MPI_Wtime() - begin << " s" << std::endl;
+		if (base.options.write_output) {
+			writeResults(ensemble, outputPath, OutputManager(base.options.run_id, base.SEED).getRunID());
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	MPI_Init(&argc, &argv);
+	int rank, size;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+	try {
+		runDriver(argc, argv, rank, size);
+	}
+	catch (const std::exception& e) { // invalid input, the library throws instead of ending the process
+		std::cout << "Rank " << rank << ": " << e.what() << std::endl;
+		MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	}
+	MPI_Finalize();
+	return 0;
+}
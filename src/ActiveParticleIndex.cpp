@@ -0,0 +1,52 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "ActiveParticleIndex.h"
+
+void ActiveParticleIndex::update(int partID, const Particle& part) {
+	if (partID >= (int)indexedType.size()) {
+		indexedType.resize(partID + 1, -1);
+		position.resize(partID + 1, -1);
+	}
+	int newType = part.isAlive() ? int(part.getType()) : -1;
+	if (indexedType[partID] == newType) {
+		return;
+	}
+	if (indexedType[partID] >= 0) {
+		remove(partID);
+	}
+	if (newType >= 0) {
+		insert(partID, PType(newType));
+	}
+}
+
+void ActiveParticleIndex::clear() {
+	for (auto& range : members) {
+		range.clear();
+	}
+	position.clear();
+	indexedType.clear();
+}
+
+void ActiveParticleIndex::insert(int partID, PType type) {
+	position[partID] = members[type].size();
+	indexedType[partID] = type;
+	members[type].push_back(partID);
+}
+
+void ActiveParticleIndex::remove(int partID) {
+	std::vector<int>& range = members[indexedType[partID]];
+	int last = range.back();
+	range[position[partID]] = last;
+	position[last] = position[partID];
+	range.pop_back();
+	position[partID] = -1;
+	indexedType[partID] = -1;
+}
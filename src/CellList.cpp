@@ -0,0 +1,44 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "CellList.h"
+#include <algorithm>
+
+CellList::CellList(const PBC& pbc, double cellSize) : pbc(pbc), box(pbc.getBoxDimension()) {
+	for (int d = 0; d < 3; ++d) {
+		nrOfCells[d] = (cellSize > 0.0) ? std::max(1, int(box[d] / cellSize)) : 1;
+		cellSide[d] = box[d] / nrOfCells[d];
+	}
+	cells.resize(nrOfCells[0] * nrOfCells[1] * nrOfCells[2]);
+	cellCoordinates.resize(cells.size());
+}
+
+std::array<int, 3> CellList::cellOf(const Eigen::Vector3d& pos) const {
+	std::array<int, 3> cell;
+	for (int d = 0; d < 3; ++d) {
+		cell[d] = std::clamp(int(pos[d] / cellSide[d]), 0, nrOfCells[d] - 1);
+	}
+	return cell;
+}
+
+void CellList::addSite(const Eigen::Vector3d& coord) {
+	Eigen::Vector3d pos = pbc.updatePostionPBC(coord);
+	std::array<int, 3> cell = cellOf(pos);
+	int c = cellIndex(cell[0], cell[1], cell[2]);
+	cells[c].push_back(nrOfSites);
+	cellCoordinates[c].push_back(pos);
+	nrOfSites++;
+}
+
+std::vector<int> CellList::sitesWithin(const Eigen::Vector3d& coord, double cutOff, int exclude) const {
+	std::vector<int> result;
+	forEachSiteWithin(coord, cutOff, exclude, [&result](int site, const Eigen::Vector3d&) { result.push_back(site); });
+	return result;
+}
@@ -0,0 +1,107 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "DisorderGenerator.h"
+#include "CellList.h"
+#include <thread>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <array>
+
+std::vector<double> DisorderGenerator::dipolarPotential(const std::vector<Eigen::Vector3d>& coordinates, RandomEngine& rng) const {
+	int nrOfSites = coordinates.size();
+	std::vector<double> potential(nrOfSites, 0.0);
+	if (nrOfSites < 2) {
+		return potential;
+	}
+
+	const Eigen::Vector3d& box = pbc.getBoxDimension();
+	double spacing = std::cbrt(box.prod() / nrOfSites);
+	double rc = (cutOff > 0.0) ? cutOff : 3.0 * spacing;
+	rc = std::min(rc, 0.5 * box.minCoeff()); // minimum image convention
+	/* Sites that (almost) overlap would dominate the sum and give a heavy tailed distribution,
+	   the distance is softened with a core of half the mean spacing */
+	double core2 = 0.25 * spacing * spacing;
+
+	/* Unit dipoles with a uniformly distributed orientation, drawn in site order */
+	std::vector<Eigen::Vector3d> dipoles(nrOfSites);
+	for (auto& dipole : dipoles) {
+		double cosTheta = 2.0 * rng.getUniform01() - 1.0;
+		double phi = 2.0 * M_PI * rng.getUniform01();
+		double sinTheta = std::sqrt(1.0 - cosTheta * cosTheta);
+		dipole << sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta;
+	}
+
+	/* The sites are visited in the order of the cells of a coarse grid, so the sites (and dipoles) that
+	   neighbouring queries touch are close together in memory */
+	double cellSize = 0.5 * rc; // smaller cells, less candidates outside the cut-off
+	std::array<int, 3> nrOfCells;
+	for (int d = 0; d < 3; ++d) {
+		nrOfCells[d] = std::max(1, int(box[d] / cellSize));
+	}
+	std::vector<long> cellKey(nrOfSites);
+	for (int i = 0; i < nrOfSites; ++i) {
+		Eigen::Vector3d pos = pbc.updatePostionPBC(coordinates[i]);
+		long key = 0;
+		for (int d = 0; d < 3; ++d) {
+			key = key * nrOfCells[d] + std::clamp(int(pos[d] / box[d] * nrOfCells[d]), 0, nrOfCells[d] - 1);
+		}
+		cellKey[i] = key;
+	}
+	std::vector<int> order(nrOfSites);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&cellKey](int a, int b) { return cellKey[a] < cellKey[b]; });
+	std::vector<Eigen::Vector3d> sortedCoordinates(nrOfSites), sortedDipoles(nrOfSites);
+	CellList cellList(pbc, cellSize);
+	for (int k = 0; k < nrOfSites; ++k) {
+		sortedCoordinates[k] = coordinates[order[k]];
+		sortedDipoles[k] = dipoles[order[k]];
+		cellList.addSite(sortedCoordinates[k]);
+	}
+
+	/* Potential at site i: sum over j of p_j . r_ji / (|r_ji|^2 + core^2)^(3/2), every thread handles a contiguous block of sites */
+	auto computeBlock = [&](int begin, int end) {
+		for (int k = begin; k < end; ++k) {
+			double phi = 0.0;
+			cellList.forEachSiteWithin(sortedCoordinates[k], rc, k, [&](int j, const Eigen::Vector3d& dr) {
+				double dist2 = dr.squaredNorm() + core2;
+				phi -= sortedDipoles[j].dot(dr) / (dist2 * std::sqrt(dist2)); // dr points from i to j
+			});
+			potential[order[k]] = phi;
+		}
+	};
+	int threads = (nrOfThreads > 0) ? nrOfThreads : std::max(1u, std::thread::hardware_concurrency());
+	threads = std::min(threads, nrOfSites);
+	std::vector<std::thread> workers;
+	int blockSize = (nrOfSites + threads - 1) / threads;
+	for (int t = 0; t < threads; ++t) {
+		int begin = t * blockSize;
+		int end = std::min(nrOfSites, begin + blockSize);
+		if (begin < end) {
+			workers.emplace_back(computeBlock, begin, end);
+		}
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	/* Standardise, the sums run in site order so the result does not depend on the number of threads */
+	double mean = 0.0;
+	for (const auto& phi : potential) mean += phi;
+	mean /= nrOfSites;
+	double var = 0.0;
+	for (const auto& phi : potential) var += (phi - mean) * (phi - mean);
+	double sigma = std::sqrt(var / nrOfSites);
+	for (auto& phi : potential) {
+		phi = (sigma > 0.0) ? (phi - mean) / sigma : 0.0;
+	}
+	return potential;
+}
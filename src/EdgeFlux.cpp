@@ -0,0 +1,105 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "EdgeFlux.h"
+#include <algorithm>
+
+void EdgeFlux::initialize(const std::vector<Site>& siteList, Mode fluxMode) {
+	mode = fluxMode;
+	if (mode == Mode::off) {
+		return;
+	}
+	offsets.resize(siteList.size() + 1, 0);
+	for (unsigned int i = 0; i < siteList.size(); ++i) {
+		offsets[i + 1] = offsets[i] + siteList[i].getSRNeighbours().size();
+	}
+}
+
+size_t EdgeFlux::slotOf(int from, int to, const std::vector<Site>& siteList) const {
+	/* The short range lists are sorted */
+	const std::vector<int>& neighbours = siteList[from].getSRNeighbours();
+	auto it = std::lower_bound(neighbours.begin(), neighbours.end(), to);
+	if (it == neighbours.end() || *it != to) {
+		return npos;
+	}
+	return offsets[from] + (it - neighbours.begin());
+}
+
+void EdgeFlux::recordSparseHop(PType type, int from, int to, const std::vector<Site>& siteList) {
+	sparse[type][key(from, to)]++;
+	/* The dense counters of a type are allocated at its first hop, in automatic mode once the map uses more
+	   memory than they would (an entry costs roughly 6 times a dense counter) */
+	if (dense[type].empty() && (mode == Mode::dense || (mode == Mode::automatic && sparse[type].size() * 6 > offsets.back()))) {
+		makeDense(type, siteList);
+	}
+}
+
+void EdgeFlux::makeDense(PType type, const std::vector<Site>& siteList) {
+	dense[type].assign(offsets.back(), 0);
+	std::unordered_map<uint64_t, uint64_t> remaining;
+	for (const auto& [k, count] : sparse[type]) {
+		size_t slot = slotOf(int(k >> 32), int(k & 0xffffffff), siteList);
+		if (slot != npos) {
+			dense[type][slot] = count;
+		}
+		else {
+			remaining[k] = count;
+		}
+	}
+	sparse[type].swap(remaining);
+}
+
+void EdgeFlux::reset() {
+	for (int t = 0; t < 4; ++t) {
+		std::fill(dense[t].begin(), dense[t].end(), 0);
+		sparse[t].clear();
+	}
+}
+
+long EdgeFlux::getHops(PType type, int from, int to, const std::vector<Site>& siteList) const {
+	size_t slot = dense[type].empty() ? npos : slotOf(from, to, siteList);
+	if (slot != npos) {
+		return dense[type][slot];
+	}
+	auto it = sparse[type].find(key(from, to));
+	return (it == sparse[type].end()) ? 0 : it->second;
+}
+
+void EdgeFlux::forEachNetFlux(const std::vector<Site>& siteList, const std::function<void(PType, int, int, long)>& f) const {
+	for (int t = 0; t < 4; ++t) {
+		PType type = PType(t);
+		/* Dense counters, the short range lists are symmetric so both directions are dense */
+		if (isDense(type)) {
+			for (unsigned int from = 0; from < siteList.size(); ++from) {
+				const std::vector<int>& neighbours = siteList[from].getSRNeighbours();
+				for (unsigned int k = 0; k < neighbours.size(); ++k) {
+					int to = neighbours[k];
+					if ((int)from > to) continue;
+					long net = (long)dense[t][offsets[from] + k] - (long)dense[t][slotOf(to, from, siteList)];
+					if (net != 0) f(type, from, to, net);
+				}
+			}
+		}
+		/* Sparse counters, every pair is reported from the entry of its smaller site or, if that does not exist, its larger site */
+		for (const auto& [k, count] : sparse[t]) {
+			int from = int(k >> 32);
+			int to = int(k & 0xffffffff);
+			auto reverse = sparse[t].find(key(to, from));
+			long backward = (reverse == sparse[t].end()) ? 0 : reverse->second;
+			if (from < to) {
+				long net = (long)count - backward;
+				if (net != 0) f(type, from, to, net);
+			}
+			else if (backward == 0) {
+				f(type, to, from, -(long)count);
+			}
+		}
+	}
+}
@@ -0,0 +1,67 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "Electrodes.h"
+#include <cmath>
+
+namespace {
+/* The partial sums of the trees are recomputed after this many updates, so their rounding errors stay bounded in long runs */
+const long rebuildInterval = 1 << 20;
+}
+
+void Electrodes::initialize(const std::vector<Site>& siteList, const RateEngine& rate_engine, PType carrier, double boxX, double range, std::array<double, 2> level) {
+	enabled = true;
+	this->carrier = carrier;
+	zoneIndex.assign(siteList.size(), { -1, -1 });
+	extractionRates.assign(siteList.size(), { 0.0, 0.0 });
+	injectionTrees.clear();
+	for (int side : { Side::left, Side::right }) {
+		double xElectrode = (side == Side::left) ? 0.0 : boxX;
+		zoneSites[side].clear();
+		injectionRates[side].clear();
+		for (unsigned int i = 0; i < siteList.size(); ++i) {
+			double x = siteList[i].getCoordinates()[0];
+			double dist = std::abs(x - xElectrode);
+			if (dist > range) {
+				continue;
+			}
+			/* Hops between the site and the point of the electrode plane closest to it */
+			double injectionEnergy = siteList[i].getEnergy(carrier) - level[side] + rate_engine.fieldEnergy(xElectrode - x, carrier);
+			double extractionEnergy = level[side] - siteList[i].getEnergy(carrier) + rate_engine.fieldEnergy(x - xElectrode, carrier);
+			zoneIndex[i][side] = zoneSites[side].size();
+			zoneSites[side].push_back(i);
+			injectionRates[side].push_back(rate_engine.millerAbrahams(dist, injectionEnergy, carrier));
+			extractionRates[i][side] = rate_engine.millerAbrahams(dist, extractionEnergy, carrier);
+		}
+		injectionTrees.emplace_back(injectionRates[side]);
+	}
+	updatesSinceRebuild = 0;
+}
+
+int Electrodes::selectInjectionSite(int side, double random01) const {
+	int index = injectionTrees[side].find(random01 * injectionTrees[side].getTotal());
+	return (index < 0) ? -1 : zoneSites[side][index];
+}
+
+void Electrodes::setOccupied(int site, bool occupied) {
+	for (int side : { Side::left, Side::right }) {
+		int index = zoneIndex[site][side];
+		if (index >= 0) {
+			injectionTrees[side].setWeight(index, occupied ? 0.0 : injectionRates[side][index]);
+			updatesSinceRebuild++;
+		}
+	}
+	if (updatesSinceRebuild >= rebuildInterval) {
+		for (auto& tree : injectionTrees) {
+			tree.rebuild();
+		}
+		updatesSinceRebuild = 0;
+	}
+}
@@ -0,0 +1,67 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "FenwickTree.h"
+#include <algorithm>
+
+FenwickTree::FenwickTree(const std::vector<double>& w) : weights(w), tree(w.size() + 1, 0.0) {
+	rebuild();
+	while (highestPower * 2 <= (int)weights.size()) {
+		highestPower *= 2;
+	}
+}
+
+void FenwickTree::rebuild() {
+	int n = weights.size();
+	std::fill(tree.begin(), tree.end(), 0.0);
+	/* O(N) construction, every node passes its sum on to its parent */
+	for (int i = 1; i <= n; ++i) {
+		tree[i] += weights[i - 1];
+		int parent = i + (i & -i);
+		if (parent <= n) {
+			tree[parent] += tree[i];
+		}
+	}
+}
+
+void FenwickTree::setWeight(int index, double weight) {
+	double delta = weight - weights[index];
+	weights[index] = weight;
+	for (int i = index + 1; i < (int)tree.size(); i += i & -i) {
+		tree[i] += delta;
+	}
+}
+
+double FenwickTree::getTotal() const {
+	double total = 0.0;
+	for (int i = tree.size() - 1; i > 0; i -= i & -i) {
+		total += tree[i];
+	}
+	return total;
+}
+
+int FenwickTree::find(double value) const {
+	int n = weights.size();
+	int pos = 0;
+	for (int step = highestPower; step > 0; step /= 2) {
+		if (pos + step <= n && tree[pos + step] <= value) {
+			pos += step;
+			value -= tree[pos];
+		}
+	}
+	/* Rounding (the partial sums are not exact after updates) can land on an empty item, take the nearest one with weight */
+	for (int i = pos; i < n; ++i) {
+		if (weights[i] > 0.0) return i;
+	}
+	for (int i = pos - 1; i >= 0; --i) {
+		if (weights[i] > 0.0) return i;
+	}
+	return -1;
+}
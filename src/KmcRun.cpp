@@ -9,37 +9,383 @@
  **************************************************/
 
 #include "KmcRun.h"
+#include "FenwickTree.h"
 #include <iostream>
 #include <chrono>
 #include <tuple>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <Eigen/Dense>
 
 void KmcRun::runSimulation() {
 	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
-	initializeSites();
-	initializeNeighbours();
-	initializeParticles();
+	initialize();
+	if (telemetry) {
+		telemetry->setTarget(nrOfSteps, timeLimit);
+	}
+
+	log() << "Initialization and setup done." << std::endl;
+
+	/* Run in chunks of 1% to give some feedback on the progress */
+	long chunk = std::max(1, nrOfSteps / 100);
+	for (long step = 0; step < nrOfSteps; step += chunk) {
+		long todo = std::min<long>(chunk, nrOfSteps - step);
+		if (runSteps(todo) < todo) {
+			break;
+		}
+		log() << "\rProgress: " << 100.0 * (step + todo) / (nrOfSteps) << "%" << std::flush;
+	}
+	log() << std::endl;
+
+	if (options.dilute && diluteInteractingEpochs > 0) {
+		log() << "Dilute mode: carriers came within interaction range in " << diluteInteractingEpochs << " epochs"
+			<< (options.dilute_fallback ? ", these continued serially from the first contact.\n" : " (ignored).\n");
+	}
+
+	if (options.batch && batchCount > 0) {
+		log() << "Batch mode: " << batchEvents << " events in " << batchCount << " batches (mean " << double(batchEvents) / batchCount
+			<< "), redrawn hops added: " << batchInserted << ", rolled back: " << batchRollbacks << "\n";
+	}
 
-	std::cout << "Initialization and setup done." << std::endl;
+	if (electrodes.isEnabled()) {
+		log() << "Electrodes: injected " << electrodes.getInjected(Electrodes::left) << " (left) " << electrodes.getInjected(Electrodes::right)
+			<< " (right), extracted " << electrodes.getExtracted(Electrodes::left) << " (left) " << electrodes.getExtracted(Electrodes::right) << " (right)";
+		if (totalTime > 0.0) {
+			log() << ", net current into the right electrode: " << (electrodes.getExtracted(Electrodes::right) - electrodes.getInjected(Electrodes::right)) / totalTime
+				<< " carriers per unit time";
+		}
+		log() << "\n";
+	}
 
-	for (int step = 0; step < nrOfSteps; ++step) {
-		computeNextEventRates();
-		executeNextEvent();
+	if (options.superbasin) {
+		log() << "Superbasin exits: " << superbasinExits << ", internal hops skipped (expected): " << superbasinHopsSkipped << "\n";
+	}
 
-		/* Give some feedback on the progress */
-		if ((step + 1) % (nrOfSteps / 100) == 0) {
-			std::cout << "\rProgress: " << 100.0 * (step + 1) / (nrOfSteps) << "%" << std::flush;
+	if (lRListsBuilt > 0) {
+		log() << "Long range neighbour lists built: " << lRListsBuilt << " (of " << siteList.size() << " sites)";
+		if (options.lR_cacheSize > 0) {
+			log() << ", evicted from the cache: " << lRCacheEvictions;
 		}
+		log() << "\n";
 	}
-	std::cout << std::endl;
 
-	OutputManager out;
-	out.printSiteOccupations(siteList, totalTime);
-	out.printParticleInfo(particleList);
+	if (options.lR_pruneFraction > 0.0 && prunedSteps > 0) {
+		log() << "Pruned Forster rate per step (upper bound): mean " << prunedRateSum / prunedSteps << ", relative to the total rate: mean "
+			<< prunedRelativeSum / prunedSteps << ", max " << prunedRelativeMax << "\n";
+	}
+
+	telemetry.reset(); // writes the last sample
+
+	OutputManager out(runID, random_engine.getSeed());
+	out.setVerbose(options.verbose);
+	if (options.write_output) {
+		if (options.output_format == "text") {
+			out.printSiteOccupations(siteList, totalTime);
+		}
+		else if (options.output_format == "binary") {
+			out.writeSiteOccupationsBinary(siteList, totalTime);
+		}
+		if (options.output_histogramBins > 0) {
+			out.printOccupationHistograms(siteList, totalTime, options.output_histogramBins);
+		}
+		if (edgeFlux.isEnabled()) {
+			out.printNetFlux(edgeFlux, siteList);
+		}
+	}
+	if (options.verbose) {
+		out.printParticleInfo(particleList);
+	}
 
 	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-	std::cout << "Total simulation time: " << (std::chrono::duration_cast<std::chrono::seconds>(end - begin).count()) << "s" << std::endl;
+	log() << "Total simulation time: " << (std::chrono::duration_cast<std::chrono::seconds>(end - begin).count()) << "s" << std::endl;
+
+}
+
+std::ostream& KmcRun::log() {
+	return options.verbose ? std::cout : nullStream;
+}
+
+WorkerPool& KmcRun::getWorkerPool(unsigned int nrOfThreads) {
+	if (!workerPool || workerPool->getNrOfThreads() != nrOfThreads) {
+		workerPool = std::make_unique<WorkerPool>(nrOfThreads);
+	}
+	return *workerPool;
+}
+
+void KmcRun::setSites(const std::vector<Eigen::Vector3d>& coordinates) {
+	std::vector<double> tempEnergies(4);
+	siteList.clear();
+	for (const auto& coord : coordinates) {
+		tempEnergies[int(PType::elec)] = random_engine.getDOSEnergy(PType::elec);
+		tempEnergies[int(PType::hole)] = random_engine.getDOSEnergy(PType::hole);
+		tempEnergies[int(PType::sing)] = random_engine.getDOSEnergy(PType::sing);
+		tempEnergies[int(PType::trip)] = random_engine.getDOSEnergy(PType::trip);
+		siteList.emplace_back(coord, tempEnergies);
+	}
+	random_engine.setNrOfSites(siteList.size());
+	if (options.disorder == "dipolar") {
+		applyCorrelatedDisorder();
+	}
+}
+
+void KmcRun::setSites(const std::vector<Eigen::Vector3d>& coordinates, const std::vector<std::vector<double>>& energies) {
+	siteList.clear();
+	for (unsigned int i = 0; i < coordinates.size(); ++i) {
+		siteList.emplace_back(coordinates[i], energies[i]);
+	}
+	random_engine.setNrOfSites(siteList.size());
+}
+
+void KmcRun::addParticle(PType type, int site) {
+	explicitParticles.emplace_back(type, site);
+}
+
+void KmcRun::initializeParticlesEquilibrium() {
+	/* Every type excludes the sites taken by itself and by the types placed before it, as in initializeParticles() */
+	const double kBT = rate_engine.getkBT();
+	int partID = 0;
+	for (PType type : { PType::elec, PType::hole, PType::trip, PType::sing }) {
+		if (nrOfParticlesPerType[type] == 0) {
+			continue;
+		}
+		auto isExcluded = [&](const Site& site) {
+			for (int t = 0; t <= type; ++t) {
+				if (site.isOccupied(PType(t))) return true;
+			}
+			return false;
+		};
+		/* Weights relative to the lowest free energy, so they do not all underflow */
+		double eMin = std::numeric_limits<double>::infinity();
+		int nrOfFreeSites = 0;
+		for (const auto& site : siteList) {
+			if (!isExcluded(site)) {
+				eMin = std::min(eMin, site.getEnergy(type));
+				nrOfFreeSites++;
+			}
+		}
+		if (nrOfParticlesPerType[type] > nrOfFreeSites) {
+			throw std::invalid_argument("Not enough free sites for the initial particles of type " + std::to_string(type) + ".");
+		}
+		std::vector<double> weights(siteList.size(), 0.0);
+		for (unsigned int i = 0; i < siteList.size(); ++i) {
+			if (!isExcluded(siteList[i])) {
+				weights[i] = std::exp(-(siteList[i].getEnergy(type) - eMin) / kBT);
+			}
+		}
+		FenwickTree tree(weights);
+		for (int i = 0; i < nrOfParticlesPerType[type]; ++i) {
+			int location = tree.find(random_engine.getUniform01() * tree.getTotal());
+			if (location < 0) { // only sites with a weight that underflowed are left
+				throw std::runtime_error("No free site with a non-zero Boltzmann weight left for the initial particles of type " + std::to_string(type) + ".");
+			}
+			tree.setWeight(location, 0.0);
+			particleList.emplace_back(location, type);
+			siteList[location].setOccupied(type, partID, 0.0);
+			partID++;
+		}
+	}
+}
+
+void KmcRun::initialize() {
+	if (initialized) {
+		return;
+	}
+	if (siteList.empty()) {
+		initializeSites();
+	}
+	initializeNeighbours();
+	if (options.edge_flux != "none") {
+		edgeFlux.initialize(siteList, options.edge_flux == "dense" ? EdgeFlux::Mode::dense :
+			options.edge_flux == "sparse" ? EdgeFlux::Mode::sparse : EdgeFlux::Mode::automatic);
+	}
+	if (explicitParticles.empty()) {
+		if (options.initial_placement == "equilibrium") {
+			initializeParticlesEquilibrium();
+		}
+		else {
+			initializeParticles();
+		}
+	}
+	else {
+		for (const auto& [type, location] : explicitParticles) {
+			particleList.emplace_back(location, type);
+			siteList[location].setOccupied(type, particleList.size() - 1, totalTime);
+		}
+	}
+	for (unsigned int i = 0; i < particleList.size(); ++i) {
+		activeParticles.update(i, particleList[i]);
+	}
+	unsigned int presentTypes = 0;
+	for (const auto& part : particleList) {
+		presentTypes |= 1u << part.getType();
+	}
+	if (options.electrodes) {
+		initializeElectrodes();
+		presentTypes |= 1u << electrodes.getCarrier();
+	}
+	if (options.specialize_types && (presentTypes == TypeSet::elecOnly || presentTypes == TypeSet::holeOnly)) {
+		typeSet = TypeSet(presentTypes);
+		carrierHopRates.assign(siteList.size(), {});
+		log() << "Event loop specialised for " << (typeSet == TypeSet::elecOnly ? "electrons" : "holes") << " only.\n";
+	}
+	runID = OutputManager(options.run_id, random_engine.getSeed()).getRunID();
+	if (!options.telemetry.empty()) {
+		telemetry = std::make_unique<Telemetry>(options.telemetry, options.telemetry_interval, runID);
+		publishTelemetry(0);
+	}
+	initialized = true;
+
+	if (options.warmup_steps > 0) {
+		/* The time limit of the run (max_time or runUntil) counts from the reset, it does not apply to the warm-up */
+		double limit = timeLimit;
+		timeLimit = 0.0;
+		long steps = runSteps(options.warmup_steps);
+		resetStatistics();
+		timeLimit = limit;
+		log() << "Warm-up of " << steps << " steps done, the clock and statistics were reset." << std::endl;
+	}
+}
+
+void KmcRun::initializeElectrodes() {
+	PType carrier = (options.electrode_carrier == "hole") ? PType::hole : PType::elec;
+	if (options.electrode_carrier == "auto" && !particleList.empty()) {
+		carrier = particleList.front().getType();
+	}
+	for (const auto& part : particleList) {
+		if (part.getType() != carrier || (carrier != PType::elec && carrier != PType::hole)) {
+			throw std::invalid_argument("With electrodes only electrons or only holes can be present (electrode_carrier " + options.electrode_carrier + ").");
+		}
+	}
+	if (options.superbasin || options.dilute || options.batch) {
+		log() << "Superbasin acceleration, dilute and batch mode are not used with electrodes.\n";
+		options.superbasin = false;
+		options.dilute = false;
+		options.batch = false;
+	}
+	double range = (options.electrode_range > 0.0) ? options.electrode_range : sR_cutOff;
+	double mean = random_engine.getDOSMean(carrier);
+	electrodes.initialize(siteList, rate_engine, carrier, pbc.getBoxDimension()[0], range, { mean - options.electrode_barrierLeft, mean - options.electrode_barrierRight });
+	for (const auto& part : particleList) {
+		electrodes.setOccupied(part.getLocation(), true);
+	}
+	log() << "Electrodes: " << electrodes.getNrOfSitesInRange(Electrodes::left) << " sites within range of the left and "
+		<< electrodes.getNrOfSitesInRange(Electrodes::right) << " of the right electrode.\n";
+}
+
+void KmcRun::resetStatistics() {
+	/* runSteps() settled the superbasins, their clocks restart with the global clock */
+	totalTime = 0.0;
+	for (auto& site : siteList) {
+		site.resetOccupation();
+	}
+	for (auto& basin : superbasins) {
+		basin.restartClock(0.0);
+	}
+	for (auto& part : particleList) {
+		part.resetDisplacement();
+	}
+	transitionCounts.fill(0);
+	waitingTimes.clear();
+	edgeFlux.reset();
+	electrodes.reset();
+	superbasinExits = 0;
+	superbasinHopsSkipped = 0.0;
+	batchCount = 0;
+	batchEvents = 0;
+	batchRollbacks = 0;
+	batchInserted = 0;
+	prunedRateSum = 0.0;
+	prunedRelativeSum = 0.0;
+	prunedRelativeMax = 0.0;
+	prunedSteps = 0;
+	if (telemetry) {
+		telemetry->restartSteps();
+		publishTelemetry(0);
+	}
+}
+
+template <TypeSet Types, bool Plain>
+long KmcRun::runEventLoop(long step, long n) {
+	const double endTime = (timeLimit > 0.0) ? timeLimit : std::numeric_limits<double>::infinity();
+	for (; step < n; ++step) {
+		if constexpr (Types == TypeSet::elecOnly) {
+			computeCarrierEventRates<PType::elec, Plain>();
+		}
+		else if constexpr (Types == TypeSet::holeOnly) {
+			computeCarrierEventRates<PType::hole, Plain>();
+		}
+		else {
+			computeNextEventRates();
+		}
+		if (next_event_list.getNrOfEvents() == 0) {
+			log() << "\nNo more events possible, all particles are gone." << std::endl;
+			break;
+		}
+		if (!executeNextEvent<Types, Plain>(endTime)) {
+			break; // time limit reached
+		}
+		if constexpr (!Plain) {
+			if (telemetry) {
+				publishTelemetry(1);
+			}
+		}
+	}
+	return step;
+}
+
+long KmcRun::runSteps(long n) {
+	initialize();
+	long step = 0;
+	if (options.dilute && !diluteFinished) {
+		step = runDilute(n);
+		publishTelemetry(step);
+	}
+	if (options.batch && !batchFinished) {
+		step += runBatched(n - step);
+	}
+	/* The feature flags are checked once here instead of every event */
+	bool plain = !options.superbasin && !electrodes.isEnabled() && !edgeFlux.isEnabled() && !options.record_waitingTimes && !telemetry;
+	switch (typeSet) {
+	case TypeSet::elecOnly:
+		step = plain ? runEventLoop<TypeSet::elecOnly, true>(step, n) : runEventLoop<TypeSet::elecOnly, false>(step, n);
+		break;
+	case TypeSet::holeOnly:
+		step = plain ? runEventLoop<TypeSet::holeOnly, true>(step, n) : runEventLoop<TypeSet::holeOnly, false>(step, n);
+		break;
+	default:
+		step = runEventLoop<TypeSet::allTypes, false>(step, n);
+	}
+
+	/* Make the occupations of carriers in a superbasin up to date */
+	for (unsigned int i = 0; i < superbasins.size(); ++i) {
+		settleSuperbasin(i, false);
+	}
+	return step;
+}
+
+long KmcRun::runUntil(double time) {
+	double oldLimit = timeLimit;
+	timeLimit = (oldLimit > 0.0) ? std::min(oldLimit, time) : time;
+	initialize();
+	if (telemetry) {
+		telemetry->setTarget(0, timeLimit);
+	}
+	long steps = runSteps(std::numeric_limits<long>::max());
+	timeLimit = oldLimit;
+	return steps;
+}
 
+void KmcRun::publishTelemetry(long newSteps) {
+	if (!telemetry) {
+		return;
+	}
+	telemetry->addSteps(newSteps);
+	telemetry->setState(totalTime, next_event_list.getTotalRate(), next_event_list.getNrOfEvents());
+	for (int t = 0; t < 5; ++t) {
+		telemetry->setPopulation(PType(t), activeParticles.getNrOfParticles(PType(t)));
+	}
 }
 
 void KmcRun::initializeSites() {
@@ -62,30 +408,121 @@ void KmcRun::initializeSites() {
 		}
 		myfile.close();
 		random_engine.setNrOfSites(siteList.size());
-		std::cout << "Number of sites in the simulation: " << siteList.size() << "\n";
+		log() << "Number of sites in the simulation: " << siteList.size() << "\n";
+		if (options.disorder == "dipolar") {
+			applyCorrelatedDisorder();
+		}
 	}
 	else {
-		std::cout << "Unable to open file: " << siteFile << std::endl;
-		std::cout << "Terminating execution." << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::runtime_error("Unable to open file: " + siteFile);
+	}
+}
+
+void KmcRun::applyCorrelatedDisorder() {
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	std::vector<Eigen::Vector3d> coordinates;
+	for (const auto& site : siteList) {
+		coordinates.push_back(site.getCoordinates());
 	}
+	const int disorderStream = -1; // the particle streams of dilute mode are numbered from 1
+	RandomEngine dipoleStream = random_engine.makeStream(disorderStream);
+	DisorderGenerator generator(pbc, options.disorder_cutOff, options.disorder_threads);
+	std::vector<double> potential = generator.dipolarPotential(coordinates, dipoleStream);
+
+	/* An electron feels -potential, a hole +potential */
+	for (unsigned int i = 0; i < siteList.size(); ++i) {
+		siteList[i].setEnergy(PType::elec, random_engine.getDOSMean(PType::elec) - random_engine.getDOSSigma(PType::elec) * potential[i]);
+		siteList[i].setEnergy(PType::hole, random_engine.getDOSMean(PType::hole) + random_engine.getDOSSigma(PType::hole) * potential[i]);
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	log() << "Correlated (dipolar) disorder generated in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms\n";
 }
 
 void KmcRun::initializeNeighbours() {
-	Eigen::Vector3d dr;
-	double dist = 0;
+	for (const auto& site : siteList) {
+		cellList.addSite(site.getCoordinates());
+	}
+	/* Short range lists are needed by all charges and excitons, the long range lists are built on demand in lRNeighboursOf() */
+	double cutOff = std::min(sR_cutOff, lR_cutOff);
 	for (unsigned int i = 0; i < siteList.size(); ++i) {
-		for (unsigned int j = i + 1; j < siteList.size(); ++j) {
-			dr = pbc.dr_PBC_corrected(siteList[i].getCoordinates(), siteList[j].getCoordinates());
-			dist = dr.norm();
-			if (dist <= lR_cutOff) {
-				siteList[i].addLRNeighbour(j);
-				siteList[j].addLRNeighbour(i);
-				if (dist <= sR_cutOff) {
-					siteList[i].addSRNeighbour(j);
-					siteList[j].addSRNeighbour(i);
-				}
+		std::vector<int> neighbours = cellList.sitesWithin(siteList[i].getCoordinates(), cutOff, i);
+		std::sort(neighbours.begin(), neighbours.end());
+		for (const auto& nb : neighbours) {
+			siteList[i].addSRNeighbour(nb);
+		}
+	}
+	if (options.lR_pruneFraction > 0.0) {
+		lRBoundTail.resize(siteList.size());
+	}
+	if (options.lR_cacheSize > 0) {
+		lRCachePosition.resize(siteList.size());
+	}
+}
+
+const std::vector<int>& KmcRun::lRNeighboursOf(int site) {
+	if (siteList[site].hasLRNeighbours()) {
+		if (options.lR_cacheSize > 0) { // most recently used to the front
+			lRCache.splice(lRCache.begin(), lRCache, lRCachePosition[site]);
+		}
+		return siteList[site].getLRNeighbours();
+	}
+
+	if (options.lR_cacheSize > 0) {
+		if ((int)lRCache.size() >= options.lR_cacheSize) { // evict the least recently used list
+			int oldSite = lRCache.back();
+			lRCache.pop_back();
+			siteList[oldSite].clearLRNeighbours();
+			if (options.lR_pruneFraction > 0.0) {
+				std::vector<double>().swap(lRBoundTail[oldSite]);
 			}
+			lRCacheEvictions++;
+		}
+		lRCache.push_front(site);
+		lRCachePosition[site] = lRCache.begin();
+	}
+	lRListsBuilt++;
+
+	std::vector<int> neighbours = cellList.sitesWithin(siteList[site].getCoordinates(), lR_cutOff, site);
+	if (options.lR_pruneFraction > 0.0) {
+		/* Sort the long range neighbours from near to far, i.e. from the largest to the smallest Forster rate bound */
+		std::vector<std::pair<double, int>> byDistance;
+		for (const auto& nb : neighbours) {
+			byDistance.emplace_back(pbc.dr_PBC_corrected(siteList[site].getCoordinates(), siteList[nb].getCoordinates()).norm(), nb);
+		}
+		std::sort(byDistance.begin(), byDistance.end());
+		std::vector<double>& tail = lRBoundTail[site];
+		tail.assign(byDistance.size() + 1, 0.0);
+		for (unsigned int k = 0; k < byDistance.size(); ++k) {
+			neighbours[k] = byDistance[k].second;
+		}
+		for (int k = byDistance.size() - 1; k >= 0; --k) {
+			tail[k] = tail[k + 1] + rate_engine.forsterUpperBound(byDistance[k].first);
+		}
+	}
+	else {
+		std::sort(neighbours.begin(), neighbours.end());
+	}
+	siteList[site].setLRNeighbours(std::move(neighbours));
+	return siteList[site].getLRNeighbours();
+}
+
+void KmcRun::pushPrunedForsterEvents(int partID, double localRate) {
+	int location = particleList[partID].getLocation();
+	const Site& site = siteList[location];
+	const std::vector<int>& neighbours = lRNeighboursOf(location);
+	const std::vector<double>& tail = lRBoundTail[location];
+	for (unsigned int k = 0; k < neighbours.size(); ++k) {
+		if (tail[k] < options.lR_pruneFraction * localRate) { // all remaining hops together are negligible
+			prunedRate += tail[k];
+			return;
+		}
+		int nb = neighbours[k];
+		if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
+			!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
+
+			double rate = rate_engine.forster(site, siteList[nb]);
+			next_event_list.pushNextEvent(rate, Transition::normalhop, partID, nb); // normal "forster" hop
+			localRate += rate;
 		}
 	}
 }
@@ -140,135 +577,314 @@ void KmcRun::initializeParticles() {
 	}
 }
 
+const std::vector<double>& KmcRun::carrierHopRatesOf(int site, PType carrier) {
+	std::vector<double>& rates = carrierHopRates[site];
+	const std::vector<int>& neighbours = siteList[site].getSRNeighbours();
+	if (rates.size() != neighbours.size()) {
+		rates.clear();
+		for (const auto& nb : neighbours) {
+			rates.push_back(rate_engine.millerAbrahams(siteList[site], siteList[nb], carrier));
+		}
+	}
+	return rates;
+}
+
+template <PType carrier, bool Plain>
+void KmcRun::computeCarrierEventRates() {
+	next_event_list.resetNextEventList();
+	for (const auto& i : activeParticles.getParticles(carrier)) {
+		if constexpr (!Plain) {
+			if (options.superbasin && pushSuperbasinEvents(i)) {
+				continue;
+			}
+		}
+		int location = particleList[i].getLocation();
+		const std::vector<int>& neighbours = siteList[location].getSRNeighbours();
+		const std::vector<double>& rates = carrierHopRatesOf(location, carrier);
+		for (unsigned int k = 0; k < neighbours.size(); ++k) {
+			if (!siteList[neighbours[k]].isOccupied(carrier)) { // normal hop
+				next_event_list.pushNextEvent(rates[k], Transition::normalhop, i, neighbours[k]);
+			}
+		}
+	}
+	if constexpr (!Plain) {
+		if (electrodes.isEnabled()) {
+			pushElectrodeEvents();
+		}
+	}
+}
+
 void KmcRun::computeNextEventRates() {
 
 	next_event_list.resetNextEventList();
+	prunedRate = 0.0;
+	double localRate = 0.0;
+	const std::vector<int> noNeighbours;
 
-	for (unsigned int i = 0; i < particleList.size(); ++i) {
+	for (const auto& i : activeParticles.getParticles(PType::elec)) {
+		Particle& part = particleList[i];
+		if (options.superbasin && pushSuperbasinEvents(i)) {
+			continue;
+		}
+		for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) {
+			if (siteList[nb].isOccupied(PType::elec) || siteList[nb].isOccupied(PType::CT) || siteList[nb].isOccupied(PType::sing) || siteList[nb].isOccupied(PType::trip)) {
+				; // nothing happens
+			}
+			else if (siteList[nb].isOccupied(PType::hole)) { //exciton generation
+				next_event_list.pushNextEvent(rate_engine.millerAbrahamsGEN(siteList[part.getLocation()], siteList[nb], PType::elec), Transition::excitonFromElec, i, nb);
+			}
+			else { // normal hop
+				next_event_list.pushNextEvent(rate_engine.millerAbrahams(siteList[part.getLocation()], siteList[nb], PType::elec), Transition::normalhop, i, nb);
+			}
+		}
+	}
+	for (const auto& i : activeParticles.getParticles(PType::hole)) {
+		Particle& part = particleList[i];
+		if (options.superbasin && pushSuperbasinEvents(i)) {
+			continue;
+		}
+		for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) {
+			if (siteList[nb].isOccupied(PType::hole) || siteList[nb].isOccupied(PType::CT) || siteList[nb].isOccupied(PType::sing) || siteList[nb].isOccupied(PType::trip)) {
+				; // nothing happens
+			}
+			else if (siteList[nb].isOccupied(PType::elec)) { // exciton generation
+				next_event_list.pushNextEvent(rate_engine.millerAbrahamsGEN(siteList[part.getLocation()], siteList[nb], PType::hole), Transition::excitonFromHole, i, nb);
+			}
+			else { // normal hop
+				next_event_list.pushNextEvent(rate_engine.millerAbrahams(siteList[part.getLocation()], siteList[nb], PType::hole), Transition::normalhop, i, nb);
+			}
+		}
+	}
+	for (const auto& i : activeParticles.getParticles(PType::sing)) {
+		Particle& part = particleList[i];
+		localRate = next_event_list.getTotalRate();
+		// it can hop, ...
+		for (const auto& nb : (options.lR_pruneFraction > 0.0) ? noNeighbours : lRNeighboursOf(part.getLocation())) { //Note: long range neighbourlist here, with pruning the hops are pushed last
+			if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
+				!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
+
+				next_event_list.pushNextEvent(rate_engine.forster(siteList[part.getLocation()], siteList[nb]), Transition::normalhop, i, nb); // normal "forster" hop
+			}
+		}
+		// ... it can decay ...
+		next_event_list.pushNextEvent(rate_engine.decay(PType::sing), Transition::decay, i, i);
+		// ... or it will dissociate into a CT state.
+		for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) { //Note: short range neighbourlist here
+			if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
+				!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
+
+				next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT(siteList[part.getLocation()], siteList[nb], PType::elec), Transition::singToCTViaElec, i, nb);
+				next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT(siteList[part.getLocation()], siteList[nb], PType::hole), Transition::singToCTViaHole, i, nb);
+			}
+		}
+		if (options.lR_pruneFraction > 0.0) {
+			pushPrunedForsterEvents(i, next_event_list.getTotalRate() - localRate);
+		}
+	}
+	for (const auto& i : activeParticles.getParticles(PType::trip)) {
+		Particle& part = particleList[i];
+		// it can hop, ...
+		for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) { //Note: short range neighbourlist here
+			if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
+				!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
+
+				next_event_list.pushNextEvent(rate_engine.millerAbrahams(siteList[part.getLocation()], siteList[nb], PType::trip), Transition::normalhop, i, nb); // normal hop
+			}
+		}
+		// ... it can decay ...
+		next_event_list.pushNextEvent(rate_engine.decay(PType::trip), Transition::decay, i, i);
+		// ... or it will dissociate into a CT state.
+		for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) { //Note: short range neighbourlist here
+			if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
+				!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
+
+				next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT(siteList[part.getLocation()], siteList[nb], PType::elec), Transition::tripToCTViaElec, i, nb);
+				next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT(siteList[part.getLocation()], siteList[nb], PType::hole), Transition::tripToCTViaHole, i, nb);
+			}
+		}
+	}
+	for (const auto& i : activeParticles.getParticles(PType::CT)) {
 		Particle& part = particleList[i];
-		if (part.isAlive()) {
-			switch (part.getType()) {
-			case PType::elec:
-				for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) {
-					if (siteList[nb].isOccupied(PType::elec) || siteList[nb].isOccupied(PType::CT) || siteList[nb].isOccupied(PType::sing) || siteList[nb].isOccupied(PType::trip)) {
-						; // nothing happens
-					}
-					else if (siteList[nb].isOccupied(PType::hole)) { //exciton generation
-						next_event_list.pushNextEvent(rate_engine.millerAbrahamsGEN(siteList[part.getLocation()], siteList[nb], part.getType()), Transition::excitonFromElec, i, nb);
-					}
-					else { // normal hop
-						next_event_list.pushNextEvent(rate_engine.millerAbrahams(siteList[part.getLocation()], siteList[nb], part.getType()), Transition::normalhop, i, nb);
-					}
-				}
-				break;
-			case PType::hole:
-				for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) {
-					if (siteList[nb].isOccupied(PType::hole) || siteList[nb].isOccupied(PType::CT) || siteList[nb].isOccupied(PType::sing) || siteList[nb].isOccupied(PType::trip)) {
-						; // nothing happens
-					}
-					else if (siteList[nb].isOccupied(PType::elec)) { // exciton generation
-						next_event_list.pushNextEvent(rate_engine.millerAbrahamsGEN(siteList[part.getLocation()], siteList[nb], part.getType()), Transition::excitonFromHole, i, nb);
-					}
-					else { // normal hop
-						next_event_list.pushNextEvent(rate_engine.millerAbrahams(siteList[part.getLocation()], siteList[nb], part.getType()), Transition::normalhop, i, nb);
-					}
-				}
-				break;
-			case PType::sing:
-				// it can hop, ...
-				for (const auto& nb : siteList[part.getLocation()].getLRNeighbours()) { //Note: long range neighbourlist here
-					if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
-						!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
-
-						next_event_list.pushNextEvent(rate_engine.forster(siteList[part.getLocation()], siteList[nb]), Transition::normalhop, i, nb); // normal "forster" hop
-					}
-				}
-				// ... it can decay ...
-				next_event_list.pushNextEvent(rate_engine.decay(part.getType()), Transition::decay, i, i);
-				// ... or it will dissociate into a CT state.
-				for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) { //Note: short range neighbourlist here
-					if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
-						!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
-
-						next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT(siteList[part.getLocation()], siteList[nb], PType::elec), Transition::singToCTViaElec, i, nb);
-						next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT(siteList[part.getLocation()], siteList[nb], PType::hole), Transition::singToCTViaHole, i, nb);
-					}
-				}
-				break;
-			case PType::trip:
-				// it can hop, ...
-				for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) { //Note: short range neighbourlist here
-					if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
-						!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
-
-						next_event_list.pushNextEvent(rate_engine.millerAbrahams(siteList[part.getLocation()], siteList[nb], part.getType()), Transition::normalhop, i, nb); // normal hop
-					}
-				}
-				// ... it can decay ...
-				next_event_list.pushNextEvent(rate_engine.decay(part.getType()), Transition::decay, i, i);
-				// ... or it will dissociate into a CT state.
-				for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) { //Note: short range neighbourlist here
-					if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
-						!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
-
-						next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT(siteList[part.getLocation()], siteList[nb], PType::elec), Transition::tripToCTViaElec, i, nb);
-						next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT(siteList[part.getLocation()], siteList[nb], PType::hole), Transition::tripToCTViaHole, i, nb);
-					}
-				}
-				break;
-			case PType::CT:
-				// it can recombine into an exciton (either the hole follows the electron or vice versa) or ...
-				next_event_list.pushNextEvent(rate_engine.millerAbrahamsGEN(siteList[part.getLocationCTelec()], siteList[part.getLocation()], PType::elec), Transition::excitonFromElecCT, i, part.getLocation());
-				next_event_list.pushNextEvent(rate_engine.millerAbrahamsGEN(siteList[part.getLocation()], siteList[part.getLocationCTelec()], PType::hole), Transition::excitonFromHoleCT, i, part.getLocationCTelec());
-				// ... it can separate into free charges
-				for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) {
-					if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
-						!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
-
-						next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT_DIS(siteList[part.getLocation()], siteList[nb], PType::hole), Transition::CTdisViaHole, i, nb);
-					}
-				}
-				for (const auto& nb : siteList[part.getLocationCTelec()].getSRNeighbours()) {
-					if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
-						!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
-
-						next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT_DIS(siteList[part.getLocation()], siteList[nb], PType::elec), Transition::CTdisViaElec, i, nb);
-					}
-				}
-				break;
+		// it can recombine into an exciton (either the hole follows the electron or vice versa) or ...
+		next_event_list.pushNextEvent(rate_engine.millerAbrahamsGEN(siteList[part.getLocationCTelec()], siteList[part.getLocation()], PType::elec), Transition::excitonFromElecCT, i, part.getLocation());
+		next_event_list.pushNextEvent(rate_engine.millerAbrahamsGEN(siteList[part.getLocation()], siteList[part.getLocationCTelec()], PType::hole), Transition::excitonFromHoleCT, i, part.getLocationCTelec());
+		// ... it can separate into free charges
+		for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) {
+			if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
+				!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
+
+				next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT_DIS(siteList[part.getLocation()], siteList[nb], PType::hole), Transition::CTdisViaHole, i, nb);
 			}
 		}
+		for (const auto& nb : siteList[part.getLocationCTelec()].getSRNeighbours()) {
+			if (!siteList[nb].isOccupied(PType::elec) && !siteList[nb].isOccupied(PType::hole) &&
+				!siteList[nb].isOccupied(PType::CT) && !siteList[nb].isOccupied(PType::sing) && !siteList[nb].isOccupied(PType::trip)) {
+
+				next_event_list.pushNextEvent(rate_engine.millerAbrahamsCT_DIS(siteList[part.getLocation()], siteList[nb], PType::elec), Transition::CTdisViaElec, i, nb);
+			}
+		}
+	}
+
+	if (electrodes.isEnabled()) {
+		pushElectrodeEvents();
+	}
+
+	if (options.lR_pruneFraction > 0.0 && next_event_list.getTotalRate() > 0.0) {
+		prunedRateSum += prunedRate;
+		prunedRelativeSum += prunedRate / next_event_list.getTotalRate();
+		prunedRelativeMax = std::max(prunedRelativeMax, prunedRate / next_event_list.getTotalRate());
+		prunedSteps++;
 	}
 }
 
-void KmcRun::executeNextEvent() {
+template <TypeSet Types, bool Plain>
+bool KmcRun::executeNextEvent(double endTime) {
 	
-	totalTime += random_engine.getInterArrivalTime(next_event_list.getTotalRate());
+	double dt = random_engine.getInterArrivalTime(next_event_list.getTotalRate());
+	if (totalTime + dt >= endTime) { // the remaining waiting time falls beyond the end of the run
+		totalTime = endTime;
+		return false;
+	}
+	totalTime += dt;
+	if constexpr (!Plain) {
+		if (options.record_waitingTimes) {
+			waitingTimes.push_back(dt);
+		}
+	}
 
 	std::tuple<Transition, int, int> nextEvent = next_event_list.getNextEvent(random_engine.getUniform01());
-	
-	int partID = std::get<1>(nextEvent);
+
+	if constexpr (Types != TypeSet::allTypes) { // a single carrier only hops (or leaves a superbasin)
+		if (std::get<0>(nextEvent) == Transition::normalhop) {
+			transitionCounts[Transition::normalhop]++;
+			hopParticle<Plain>(std::get<1>(nextEvent), std::get<2>(nextEvent));
+			return true;
+		}
+	}
+	executeEvent(std::get<0>(nextEvent), std::get<1>(nextEvent), std::get<2>(nextEvent));
+	return true;
+}
+
+template <bool Plain>
+void KmcRun::hopParticle(int partID, int newLocation) {
 	Particle& part = particleList[partID];
-		
-	int newLocation = std::get<2>(nextEvent);
 	int oldLocation = part.getLocation();
+	part.jumpTo(newLocation, pbc.dr_PBC_corrected(siteList[oldLocation].getCoordinates(), siteList[newLocation].getCoordinates()));
+	siteList[oldLocation].freeSite(part.getType(), totalTime);
+	siteList[newLocation].setOccupied(part.getType(), partID, totalTime);
+	if constexpr (!Plain) {
+		if (electrodes.isEnabled()) {
+			electrodes.setOccupied(oldLocation, false);
+			electrodes.setOccupied(newLocation, true);
+		}
+		if (edgeFlux.isEnabled()) {
+			edgeFlux.recordHop(part.getType(), oldLocation, newLocation, siteList);
+		}
+		if (options.superbasin) {
+			recordCarrierHop(partID);
+		}
+	}
+}
+
+void KmcRun::pushElectrodeEvents() {
+	for (int side : { Electrodes::left, Electrodes::right }) {
+		double injectionRate = electrodes.getInjectionRate(side);
+		if (injectionRate > 0.0) {
+			next_event_list.pushNextEvent(injectionRate, Transition::injection, side, -1);
+		}
+		for (const auto& i : activeParticles.getParticles(electrodes.getCarrier())) {
+			double extractionRate = electrodes.getExtractionRate(side, particleList[i].getLocation());
+			if (extractionRate > 0.0) {
+				next_event_list.pushNextEvent(extractionRate, Transition::extraction, i, side);
+			}
+		}
+	}
+}
+
+void KmcRun::injectParticle(int side) {
+	PType carrier = electrodes.getCarrier();
+	int location = electrodes.selectInjectionSite(side, random_engine.getUniform01());
+	if (location < 0) { // rounding of the total injection rate, no site in range is free
+		return;
+	}
+	int partID;
+	if (freeSlots.empty()) {
+		partID = particleList.size();
+		particleList.emplace_back(location, carrier);
+	}
+	else {
+		partID = freeSlots.back();
+		freeSlots.pop_back();
+		particleList[partID] = Particle(location, carrier);
+	}
+	siteList[location].setOccupied(carrier, partID, totalTime);
+	electrodes.setOccupied(location, true);
+	electrodes.recordInjection(side);
+	activeParticles.update(partID, particleList[partID]);
+}
+
+void KmcRun::extractParticle(int partID, int side) {
+	Particle& part = particleList[partID];
+	siteList[part.getLocation()].freeSite(part.getType(), totalTime);
+	electrodes.setOccupied(part.getLocation(), false);
+	part.killParticle(totalTime);
+	freeSlots.push_back(partID);
+	electrodes.recordExtraction(side);
+	activeParticles.update(partID, part);
+}
+
+void KmcRun::executeEvent(Transition transition, int partID, int newLocation) {
+	/* For an injection partID is the electrode, for an extraction newLocation is */
+	if (transition == Transition::injection || transition == Transition::extraction) {
+		transitionCounts[transition]++;
+		if (transition == Transition::injection) {
+			injectParticle(partID);
+		}
+		else {
+			extractParticle(partID, newLocation);
+		}
+		return;
+	}
+
+	Particle& part = particleList[partID];
+	int oldLocation = part.getLocation();
+	unsigned int nrOfParticles = particleList.size();
+
+	/* The exciton partner changes type */
+	int partner = -1;
+	if (transition == Transition::excitonFromElec) {
+		partner = siteList[newLocation].isOccupiedBy(PType::hole);
+	}
+	else if (transition == Transition::excitonFromHole) {
+		partner = siteList[newLocation].isOccupiedBy(PType::elec);
+	}
 
 	PType type;
 	Particle* tempParticle;
 
-	switch (std::get<0>(nextEvent)) {
+	transitionCounts[transition]++;
+	switch (transition) {
 	case Transition::normalhop:
-		part.jumpTo(newLocation, pbc.dr_PBC_corrected(siteList[oldLocation].getCoordinates(), siteList[newLocation].getCoordinates()));
-		siteList[oldLocation].freeSite(part.getType(), totalTime);
-		siteList[newLocation].setOccupied(part.getType(), partID, totalTime);
+		hopParticle(partID, newLocation);
+		break;
+
+	case Transition::superbasinExit:
+		executeSuperbasinExit(partID, newLocation);
 		break;
 
+	case Transition::injection:
+	case Transition::extraction:
+		break; // done above, these events do not belong to a particle
+
 	case Transition::decay:
 		siteList[oldLocation].freeSite(part.getType(), totalTime);
 		part.killParticle(totalTime);
 		break;
 
 	case Transition::excitonFromElec:
+		if (options.superbasin) {
+			settleSuperbasin(siteList[newLocation].isOccupiedBy(PType::hole));
+		}
 		siteList[oldLocation].freeSite(PType::elec, totalTime);
 		type = particleList[siteList[newLocation].isOccupiedBy(PType::hole)].makeExciton(random_engine.getUniform01());
 		siteList[newLocation].changeOccupied(PType::hole, type, partID, totalTime);
@@ -282,6 +898,9 @@ void KmcRun::executeNextEvent() {
 		break;
 
 	case Transition::excitonFromHole:
+		if (options.superbasin) {
+			settleSuperbasin(siteList[newLocation].isOccupiedBy(PType::elec));
+		}
 		siteList[oldLocation].freeSite(PType::hole, totalTime);
 		type = particleList[siteList[newLocation].isOccupiedBy(PType::elec)].makeExciton(random_engine.getUniform01());
 		siteList[newLocation].changeOccupied(PType::elec, type, partID, totalTime);
@@ -350,6 +969,140 @@ void KmcRun::executeNextEvent() {
 		siteList[newLocation].setOccupied(PType::hole, partID, totalTime);
 		siteList[oldElecLocation].setOccupied(PType::elec, particleList.size() - 1, totalTime); 
 		break;
-	}		
+	}
+
+	/* Only the particle itself, its exciton partner and new particles can have changed type or died */
+	activeParticles.update(partID, particleList[partID]);
+	if (partner >= 0) {
+		activeParticles.update(partner, particleList[partner]);
+	}
+	for (unsigned int i = nrOfParticles; i < particleList.size(); ++i) {
+		activeParticles.update(i, particleList[i]);
+	}
 }
 
+
+void KmcRun::recordCarrierHop(int partID) {
+	const Particle& part = particleList[partID];
+	if (part.getType() != PType::elec && part.getType() != PType::hole) {
+		return;
+	}
+	if (superbasins.size() < particleList.size()) {
+		superbasins.resize(particleList.size());
+	}
+	Superbasin& basin = superbasins[partID];
+	basin.recordHop(part.getLocation(), options.superbasin_history);
+	basin.detect(options.superbasin_maxSites, options.superbasin_history, part.getLocation(), totalTime);
+}
+
+bool KmcRun::pushSuperbasinEvents(int partID) {
+	if ((unsigned int)partID >= superbasins.size() || !superbasins[partID].isActive()) {
+		return false;
+	}
+	Superbasin& basin = superbasins[partID];
+	PType type = particleList[partID].getType();
+	PType other = (type == PType::elec) ? PType::hole : PType::elec;
+	Transition generation = (type == PType::elec) ? Transition::excitonFromElec : Transition::excitonFromHole;
+
+	/* The continuous time generator of the basin, the exits act as absorbing states */
+	int nrOfSites = basin.getNrOfSites();
+	Eigen::MatrixXd generator = Eigen::MatrixXd::Zero(nrOfSites, nrOfSites);
+	Eigen::VectorXd internalRate = Eigen::VectorXd::Zero(nrOfSites);
+	basin.exits.clear();
+	for (int j = 0; j < nrOfSites; ++j) {
+		const Site& site = siteList[basin.getSite(j)];
+		if (basin.getSite(j) != basin.getEntrySite() && (site.isOccupied(type) || site.isOccupied(other) || site.isOccupied(PType::CT) || site.isOccupied(PType::sing) || site.isOccupied(PType::trip))) {
+			settleSuperbasin(partID); // another particle entered the basin
+			return false;
+		}
+		for (const auto& nb : site.getSRNeighbours()) {
+			int l = basin.indexOf(nb);
+			double rate = 0.0;
+			if (l >= 0) { // internal hop
+				rate = rate_engine.millerAbrahams(site, siteList[nb], type);
+				generator(j, l) -= rate;
+				internalRate[j] += rate;
+			}
+			else if (siteList[nb].isOccupied(type) || siteList[nb].isOccupied(PType::CT) || siteList[nb].isOccupied(PType::sing) || siteList[nb].isOccupied(PType::trip)) {
+				; // nothing happens
+			}
+			else if (siteList[nb].isOccupied(other)) { // exciton generation
+				rate = rate_engine.millerAbrahamsGEN(site, siteList[nb], type);
+				basin.exits.push_back(Superbasin::Exit{ basin.getSite(j), nb, generation, rate });
+			}
+			else { // normal hop out of the basin
+				rate = rate_engine.millerAbrahams(site, siteList[nb], type);
+				basin.exits.push_back(Superbasin::Exit{ basin.getSite(j), nb, Transition::normalhop, rate });
+			}
+			generator(j, j) += rate;
+		}
+	}
+	if (basin.exits.empty()) {
+		settleSuperbasin(partID);
+		return false;
+	}
+
+	/* Expected residence times T, starting from the entry site: T^T = p0^T * generator^-1 */
+	Eigen::VectorXd p0 = Eigen::VectorXd::Zero(nrOfSites);
+	p0[basin.indexOf(basin.getEntrySite())] = 1.0;
+	Eigen::VectorXd residenceTime = generator.transpose().partialPivLu().solve(p0);
+	double escapeTime = residenceTime.sum();
+
+	/* Exit via (j,k) happens with probability T_j * r_jk, the effective rate divides that by the escape time */
+	basin.residence.resize(nrOfSites);
+	for (int j = 0; j < nrOfSites; ++j) {
+		basin.residence[j] = residenceTime[j] / escapeTime;
+	}
+	basin.internalHopsPerExit = residenceTime.dot(internalRate);
+	for (unsigned int k = 0; k < basin.exits.size(); ++k) {
+		const Superbasin::Exit& exit = basin.exits[k];
+		next_event_list.pushNextEvent(basin.residence[basin.indexOf(exit.source)] * exit.rate, Transition::superbasinExit, partID, k);
+	}
+	return true;
+}
+
+void KmcRun::settleSuperbasin(int partID, bool dissolve) {
+	if ((unsigned int)partID >= superbasins.size() || !superbasins[partID].isActive()) {
+		return;
+	}
+	Superbasin& basin = superbasins[partID];
+	PType type = particleList[partID].getType();
+
+	/* The particle stays on the entry site while in the basin, spread its occupation over the basin sites */
+	if ((int)basin.residence.size() == basin.getNrOfSites()) {
+		double dt = totalTime - basin.getEntryTime();
+		for (int j = 0; j < basin.getNrOfSites(); ++j) {
+			if (basin.getSite(j) == basin.getEntrySite()) {
+				siteList[basin.getSite(j)].addOccupation(type, -dt * (1.0 - basin.residence[j]));
+			}
+			else {
+				siteList[basin.getSite(j)].addOccupation(type, dt * basin.residence[j]);
+			}
+		}
+	}
+	basin.restartClock(totalTime);
+	if (dissolve) {
+		basin.clear();
+	}
+}
+
+void KmcRun::executeSuperbasinExit(int partID, int exitID) {
+	Superbasin& basin = superbasins[partID];
+	Superbasin::Exit exit = basin.exits[exitID];
+	superbasinExits++;
+	superbasinHopsSkipped += basin.internalHopsPerExit;
+	settleSuperbasin(partID);
+
+	/* Move the particle to the basin site it leaves from, then perform the actual transition */
+	Particle& part = particleList[partID];
+	int entrySite = part.getLocation();
+	if (exit.source != entrySite) {
+		part.jumpTo(exit.source, pbc.dr_PBC_corrected(siteList[entrySite].getCoordinates(), siteList[exit.source].getCoordinates()));
+		siteList[entrySite].freeSite(part.getType(), totalTime);
+		siteList[exit.source].setOccupied(part.getType(), partID, totalTime);
+		if (edgeFlux.isEnabled()) { // the hops inside the basin are skipped, their net result is one move from the entry site to the source
+			edgeFlux.recordHop(part.getType(), entrySite, exit.source, siteList);
+		}
+	}
+	executeEvent(exit.type, partID, exit.target);
+}
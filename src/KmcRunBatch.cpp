@@ -0,0 +1,333 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * Batch mode of KmcRun, for runs with a single
+ * carrier type. Every carrier has its own clock and
+ * chosen hop (first reaction method). The events of
+ * a time window are taken in time order as long as
+ * the neighbourhoods of their two sites are disjoint
+ * from those of the earlier events, so no event
+ * changes the rates of another event in the batch.
+ * The batch is executed and the clocks of the
+ * carriers next to the hops are redrawn on a pool
+ * of worker threads. A redrawn hop that falls before
+ * a later event of the batch joins the batch if it
+ * does not touch the later events, otherwise the
+ * later events are rolled back and stay on the
+ * queue. What is committed is the exact event
+ * sequence of a serial run.
+ **************************************************/
+
+#include "KmcRun.h"
+#include <thread>
+#include <algorithm>
+#include <queue>
+#include <limits>
+
+namespace {
+
+struct BatchWalker {
+	int partID;
+	double clock;
+	int target;
+	double totalRate;
+	int version = 0; // queue entries of older versions are outdated
+	std::vector<double> rates{}; // scratch space for the hop rates
+};
+
+struct BatchEvent {
+	int walker;
+	int from;
+	int to;
+	double time;
+};
+
+/* The state of a walker before an event of the batch redrew it */
+struct Redraw {
+	int event;
+	int walker;
+	BatchWalker before;
+};
+
+struct QueueEntry {
+	double time;
+	int walker;
+	int version;
+	bool operator>(const QueueEntry& other) const { return time > other.time; }
+};
+
+}
+
+long KmcRun::runBatched(long maxSteps) {
+	PType carrier = PType::elec;
+	std::vector<BatchWalker> walkers;
+	std::vector<int> walkerOf(particleList.size(), -1);
+	for (unsigned int i = 0; i < particleList.size(); ++i) {
+		if (!particleList[i].isAlive()) continue;
+		PType type = particleList[i].getType();
+		if ((type != PType::elec && type != PType::hole) || (!walkers.empty() && type != carrier)) {
+			log() << "Batch mode only supports runs with electrons or holes alone, continuing with the serial event loop." << std::endl;
+			batchFinished = true;
+			return 0;
+		}
+		carrier = type;
+		walkerOf[i] = walkers.size();
+		walkers.push_back(BatchWalker{ (int)i, totalTime, -1, 0.0 });
+	}
+	if (walkers.empty()) {
+		return 0;
+	}
+	if (options.superbasin) {
+		log() << "Superbasin acceleration is not used in batch mode." << std::endl;
+		options.superbasin = false;
+	}
+	/* The batch streams are numbered downwards from -2 (-1 is the disorder stream, the dilute streams count up from 1) */
+	for (unsigned int i = batchStreams.size(); i < particleList.size(); ++i) {
+		batchStreams.push_back(random_engine.makeStream(-2 - (int)i));
+	}
+	unsigned int nrOfThreads = options.batch_threads > 0 ? options.batch_threads : std::max(1u, std::thread::hardware_concurrency());
+
+	WorkerPool& pool = getWorkerPool(nrOfThreads);
+
+	/* Runs work(0..count-1), on the worker pool if there is enough work to share */
+	auto parallelFor = [&](int count, auto&& work) {
+		const int minItemsPerThread = 4;
+		if (count < 2 * minItemsPerThread) {
+			for (int i = 0; i < count; ++i) work(i);
+			return;
+		}
+		pool.run(count, work);
+	};
+
+	/* Redraws the clock and hop of a walker whose rates changed at time t0 (memoryless, so the old clock is simply replaced) */
+	auto drawEvent = [&](BatchWalker& walker, double t0) {
+		const Site& site = siteList[particleList[walker.partID].getLocation()];
+		RandomEngine& rng = batchStreams[walker.partID];
+		walker.rates.clear();
+		walker.totalRate = 0.0;
+		for (const auto& nb : site.getSRNeighbours()) {
+			double rate = siteList[nb].isOccupied(carrier) ? 0.0 : rate_engine.millerAbrahams(site, siteList[nb], carrier);
+			walker.rates.push_back(rate);
+			walker.totalRate += rate;
+		}
+		if (walker.totalRate <= 0.0) {
+			walker.clock = std::numeric_limits<double>::infinity();
+			walker.target = -1;
+			return;
+		}
+		walker.clock = t0 + rng.getInterArrivalTime(walker.totalRate);
+		double select = (1.0 - rng.getUniform01()) * walker.totalRate; // in (0, totalRate], never selects a zero rate
+		double cumSum = 0.0;
+		unsigned int k = 0, last = 0;
+		for (; k < walker.rates.size(); ++k) {
+			if (walker.rates[k] <= 0.0) continue;
+			last = k;
+			cumSum += walker.rates[k];
+			if (cumSum >= select) break;
+		}
+		walker.target = site.getSRNeighbours()[std::min(k, last)];
+	};
+
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+	auto enqueue = [&](int w) {
+		BatchWalker& walker = walkers[w];
+		walker.version++;
+		if (walker.target >= 0) {
+			queue.push(QueueEntry{ walker.clock, w, walker.version });
+		}
+	};
+	parallelFor(walkers.size(), [&](int w) { drawEvent(walkers[w], totalTime); });
+	for (unsigned int w = 0; w < walkers.size(); ++w) {
+		enqueue(w);
+	}
+
+	/* The neighbourhood of a hop: both sites and their neighbours */
+	auto forEachInRegion = [&](const BatchEvent& event, auto&& f) {
+		for (int site : { event.from, event.to }) {
+			f(site);
+			for (const auto& nb : siteList[site].getSRNeighbours()) f(nb);
+		}
+	};
+
+	std::vector<long> regionStamp(siteList.size(), -1);
+	std::vector<int> regionEvent(siteList.size(), -1); // the batch event whose region holds the site
+	std::vector<long> dirtyStamp(walkers.size(), 0);
+	std::vector<long> enqueuedStamp(walkers.size(), -1);
+	long eventStamp = 0;
+	std::vector<BatchEvent> batch;
+	std::vector<Redraw> redraws;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> pending; // redrawn hops inside the batch
+	long committedSteps = 0;
+	while (committedSteps < maxSteps && (timeLimit <= 0.0 || totalTime < timeLimit)) {
+		double sumRate = 0.0;
+		for (const auto& walker : walkers) {
+			sumRate += walker.totalRate;
+		}
+		if (queue.empty() || sumRate <= 0.0) {
+			break; // the serial loop reports that no events are left
+		}
+		double windowEnd = totalTime + options.batch_window / sumRate;
+
+		/* Select the batch, the first event is always taken */
+		batch.clear();
+		while (!queue.empty() && committedSteps + (long)batch.size() < maxSteps) {
+			QueueEntry entry = queue.top();
+			const BatchWalker& walker = walkers[entry.walker];
+			if (entry.version != walker.version) {
+				queue.pop();
+				continue;
+			}
+			if ((timeLimit > 0.0 && entry.time >= timeLimit) || (!batch.empty() && entry.time >= windowEnd)) {
+				break;
+			}
+			BatchEvent event{ entry.walker, particleList[walker.partID].getLocation(), walker.target, entry.time };
+			bool conflict = false;
+			forEachInRegion(event, [&](int site) { conflict = conflict || regionStamp[site] == batchCount; });
+			if (conflict) {
+				break;
+			}
+			forEachInRegion(event, [&](int site) {
+				regionStamp[site] = batchCount;
+				regionEvent[site] = batch.size();
+			});
+			batch.push_back(event);
+			queue.pop();
+		}
+		if (batch.empty()) {
+			if (timeLimit > 0.0 && !queue.empty()) {
+				totalTime = timeLimit; // the next event falls beyond the end of the run
+			}
+			break;
+		}
+		batchCount++;
+
+		/* The sites of the events are all different, so the hops can be done in any order */
+		parallelFor(batch.size(), [&](int e) {
+			const BatchEvent& event = batch[e];
+			int partID = walkers[event.walker].partID;
+			particleList[partID].jumpTo(event.to, pbc.dr_PBC_corrected(siteList[event.from].getCoordinates(), siteList[event.to].getCoordinates()));
+			siteList[event.from].freeSite(carrier, event.time);
+			siteList[event.to].setOccupied(carrier, partID, event.time);
+		});
+
+			/* Every carrier in a region is affected by that event only (the moved carrier included), the old state goes to the log */
+		redraws.clear();
+		for (unsigned int e = 0; e < batch.size(); ++e) {
+			eventStamp++;
+			forEachInRegion(batch[e], [&](int site) {
+				if (siteList[site].isOccupied(carrier)) {
+					int w = walkerOf[siteList[site].isOccupiedBy(carrier)];
+					if (dirtyStamp[w] == eventStamp) return; // the neighbourhoods of from and to overlap
+					dirtyStamp[w] = eventStamp;
+					redraws.push_back(Redraw{ (int)e, w, walkers[w] });
+				}
+			});
+		}
+		parallelFor(redraws.size(), [&](int d) { drawEvent(walkers[redraws[d].walker], batch[redraws[d].event].time); });
+
+		/* A redrawn carrier can hop before the last event of the batch. Such hops are taken in time order and added to the batch
+		   as long as their neighbourhood is disjoint from those of the later events. At the first one that is not, the batch is
+		   cut and the later events are rolled back, they stay on the queue. */
+		double lastTime = 0.0;
+		for (const auto& event : batch) {
+			lastTime = std::max(lastTime, event.time);
+		}
+		pending = decltype(pending)();
+		for (const auto& redraw : redraws) {
+			if (walkers[redraw.walker].clock < lastTime) {
+				pending.push(QueueEntry{ walkers[redraw.walker].clock, redraw.walker, 0 });
+			}
+		}
+		double cut = std::numeric_limits<double>::infinity();
+		while (!pending.empty()) {
+			QueueEntry entry = pending.top();
+			pending.pop();
+			BatchWalker& walker = walkers[entry.walker];
+			if (entry.time != walker.clock || walker.target < 0) {
+				continue; // redrawn again since
+			}
+			if (entry.time >= lastTime) {
+				break;
+			}
+			BatchEvent event{ entry.walker, particleList[walker.partID].getLocation(), walker.target, entry.time };
+			bool conflict = committedSteps + (long)batch.size() >= maxSteps;
+			forEachInRegion(event, [&](int site) {
+				conflict = conflict || (regionStamp[site] == batchCount - 1 && batch[regionEvent[site]].time > event.time);
+			});
+			if (conflict) {
+				cut = event.time;
+				break;
+			}
+			int partID = walker.partID;
+			particleList[partID].jumpTo(event.to, pbc.dr_PBC_corrected(siteList[event.from].getCoordinates(), siteList[event.to].getCoordinates()));
+			siteList[event.from].freeSite(carrier, event.time);
+			siteList[event.to].setOccupied(carrier, partID, event.time);
+			batch.push_back(event);
+			eventStamp++;
+			forEachInRegion(event, [&](int site) {
+				if (siteList[site].isOccupied(carrier)) {
+					int w = walkerOf[siteList[site].isOccupiedBy(carrier)];
+					if (dirtyStamp[w] == eventStamp) return;
+					dirtyStamp[w] = eventStamp;
+					redraws.push_back(Redraw{ (int)batch.size() - 1, w, walkers[w] });
+					drawEvent(walkers[w], event.time);
+					if (walkers[w].clock < lastTime) {
+						pending.push(QueueEntry{ walkers[w].clock, w, 0 });
+					}
+				}
+			});
+			batchInserted++;
+		}
+
+		/* Roll back the events after the cut in the reverse order of execution, the walkers get their state from before them */
+		unsigned int kept = batch.size();
+		if (cut < lastTime) {
+			for (unsigned int d = redraws.size(); d-- > 0;) {
+				if (batch[redraws[d].event].time > cut) {
+					int version = walkers[redraws[d].walker].version;
+					walkers[redraws[d].walker] = redraws[d].before;
+					walkers[redraws[d].walker].version = version;
+				}
+			}
+			for (unsigned int e = batch.size(); e-- > 0;) {
+				const BatchEvent& event = batch[e];
+				if (event.time <= cut) continue;
+				int partID = walkers[event.walker].partID;
+				particleList[partID].jumpTo(event.from, pbc.dr_PBC_corrected(siteList[event.to].getCoordinates(), siteList[event.from].getCoordinates()));
+				siteList[event.to].freeSite(carrier, event.time);
+				siteList[event.from].setOccupied(carrier, partID, event.time); // continues the occupation that was ended at event.time
+			}
+			batch.erase(std::remove_if(batch.begin(), batch.end(), [&](const BatchEvent& event) { return event.time > cut; }), batch.end());
+			batchRollbacks += kept - batch.size();
+			kept = batch.size();
+		}
+		for (const auto& redraw : redraws) {
+			if (enqueuedStamp[redraw.walker] != batchCount) { // enqueue every walker once
+				enqueuedStamp[redraw.walker] = batchCount;
+				enqueue(redraw.walker);
+			}
+		}
+		std::sort(batch.begin(), batch.end(), [](const BatchEvent& a, const BatchEvent& b) { return a.time < b.time; });
+
+		/* Commit in time order */
+		for (const auto& event : batch) {
+			if (options.record_waitingTimes) {
+				waitingTimes.push_back(event.time - totalTime);
+			}
+			totalTime = event.time;
+			transitionCounts[Transition::normalhop]++;
+			if (edgeFlux.isEnabled()) {
+				edgeFlux.recordHop(carrier, event.from, event.to, siteList);
+			}
+		}
+		committedSteps += kept;
+		batchEvents += kept;
+		publishTelemetry(kept);
+	}
+	return committedSteps;
+}
@@ -0,0 +1,319 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * Dilute mode of KmcRun. In the dilute limit the
+ * carriers do not interact, so every carrier is a
+ * separate Markov chain that can be advanced on its
+ * own thread with its own clock and random stream.
+ * All carriers are synchronised at the end of an
+ * epoch, then their visits are checked for overlaps
+ * in space (one hop) and time. The epoch is
+ * committed to the site occupations up to the first
+ * overlap, from there the serial event loop runs
+ * until the carriers are apart again.
+ **************************************************/
+
+#include "KmcRun.h"
+#include <thread>
+#include <algorithm>
+#include <tuple>
+#include <limits>
+
+namespace {
+
+struct Visit {
+	int site;
+	double tIn;
+	double tOut;
+};
+
+struct DiluteWalker {
+	int partID;
+	RandomEngine* rng;
+	double clock;
+	long steps = 0;
+	std::vector<Visit> visits{}; // visits of the current epoch
+	std::vector<double> rates{}; // scratch space for the hop rates
+};
+
+/* Returns the earliest time at which two walkers visited the same or neighbouring sites, infinity if they never did */
+double firstInteraction(const std::vector<DiluteWalker>& walkers, const std::vector<Site>& siteList, std::vector<int>& visitHead) {
+	std::vector<const Visit*> visits;
+	std::vector<int> owner;
+	std::vector<int> nextVisit;
+	for (unsigned int w = 0; w < walkers.size(); ++w) {
+		for (const auto& visit : walkers[w].visits) {
+			nextVisit.push_back(visitHead[visit.site]);
+			visitHead[visit.site] = visits.size();
+			visits.push_back(&visit);
+			owner.push_back(w);
+		}
+	}
+
+	double first = std::numeric_limits<double>::infinity();
+	for (unsigned int g = 0; g < visits.size(); ++g) {
+		const Visit& visit = *visits[g];
+		if (visit.tIn >= first) continue;
+		auto overlaps = [&](int site) {
+			for (int h = visitHead[site]; h >= 0; h = nextVisit[h]) {
+				if (owner[h] != owner[g] && visit.tIn < visits[h]->tOut && visits[h]->tIn < visit.tOut) {
+					first = std::min(first, std::max(visit.tIn, visits[h]->tIn));
+				}
+			}
+		};
+		overlaps(visit.site);
+		for (const auto& nb : siteList[visit.site].getSRNeighbours()) {
+			overlaps(nb);
+		}
+	}
+
+	for (const auto& visit : visits) {
+		visitHead[visit->site] = -1;
+	}
+	return first;
+}
+
+}
+
+long KmcRun::runDilute(long maxSteps) {
+	std::vector<DiluteWalker> walkers;
+	/* The streams continue where the previous call stopped, so consecutive chunks of a run draw different numbers */
+	for (unsigned int i = diluteStreams.size(); i < particleList.size(); ++i) {
+		diluteStreams.push_back(random_engine.makeStream(i + 1));
+	}
+	for (unsigned int i = 0; i < particleList.size(); ++i) {
+		if (!particleList[i].isAlive()) continue;
+		if (particleList[i].getType() != PType::elec && particleList[i].getType() != PType::hole) {
+			log() << "Dilute mode only supports electrons and holes, continuing with the serial event loop." << std::endl;
+			diluteFinished = true;
+			return 0;
+		}
+		walkers.push_back(DiluteWalker{ (int)i, &diluteStreams[i], totalTime });
+	}
+	if (walkers.empty()) {
+		return 0;
+	}
+	if (options.superbasin) {
+		log() << "Superbasin acceleration is not used in dilute mode." << std::endl;
+		options.superbasin = false;
+	}
+	unsigned int nrOfThreads = options.dilute_threads > 0 ? options.dilute_threads : std::max(1u, std::thread::hardware_concurrency());
+	WorkerPool& pool = getWorkerPool(nrOfThreads);
+
+	/* Carriers only occupy sites in the site list again when the dilute mode ends */
+	double meanRate = 0.0;
+	for (const auto& walker : walkers) {
+		const Particle& part = particleList[walker.partID];
+		const Site& site = siteList[part.getLocation()];
+		for (const auto& nb : site.getSRNeighbours()) {
+			meanRate += rate_engine.millerAbrahams(site, siteList[nb], part.getType());
+		}
+		siteList[part.getLocation()].freeSite(part.getType(), totalTime);
+	}
+	meanRate /= walkers.size();
+	double epochLength = (meanRate > 0.0) ? options.dilute_epochSteps / meanRate : 1.0;
+
+	auto advanceWalker = [&](DiluteWalker& walker, double epochEnd) {
+		Particle& part = particleList[walker.partID];
+		walker.visits.clear();
+		walker.steps = 0;
+		double tIn = walker.clock;
+		while (true) {
+			int location = part.getLocation();
+			const Site& site = siteList[location];
+			double totalRate = 0.0;
+			walker.rates.clear();
+			for (const auto& nb : site.getSRNeighbours()) {
+				walker.rates.push_back(rate_engine.millerAbrahams(site, siteList[nb], part.getType()));
+				totalRate += walker.rates.back();
+			}
+			double dt = walker.rng->getInterArrivalTime(totalRate);
+			if (walker.clock + dt >= epochEnd) { // the waiting time is memoryless, the remainder is redrawn next epoch
+				walker.visits.push_back(Visit{ location, tIn, epochEnd });
+				walker.clock = epochEnd;
+				return;
+			}
+			walker.clock += dt;
+			walker.visits.push_back(Visit{ location, tIn, walker.clock });
+			tIn = walker.clock;
+
+			double select = totalRate * walker.rng->getUniform01();
+			double cumSum = 0.0;
+			unsigned int k = 0;
+			for (; k < walker.rates.size() - 1; ++k) {
+				cumSum += walker.rates[k];
+				if (cumSum >= select) break;
+			}
+			int target = site.getSRNeighbours()[k];
+			part.jumpTo(target, pbc.dr_PBC_corrected(site.getCoordinates(), siteList[target].getCoordinates()));
+			walker.steps++;
+		}
+	};
+
+	/* Runs the serial event loop until no carrier has another one on a neighbouring site (checked every dilute_epochSteps steps),
+	   returns false if the carriers can no longer be treated independently */
+	auto runSerially = [&](long& steps) {
+		for (const auto& walker : walkers) {
+			const Particle& part = particleList[walker.partID];
+			siteList[part.getLocation()].setOccupied(part.getType(), walker.partID, totalTime);
+		}
+		std::vector<PType> types;
+		for (const auto& walker : walkers) {
+			types.push_back(particleList[walker.partID].getType());
+		}
+		unsigned int nrOfParticles = particleList.size();
+		auto unchanged = [&]() {
+			if (particleList.size() != nrOfParticles) {
+				return false;
+			}
+			for (unsigned int w = 0; w < walkers.size(); ++w) {
+				const Particle& part = particleList[walkers[w].partID];
+				if (!part.isAlive() || part.getType() != types[w]) {
+					return false;
+				}
+			}
+			return true;
+		};
+		auto separated = [&]() {
+			for (const auto& walker : walkers) {
+				const Particle& part = particleList[walker.partID];
+				for (const auto& nb : siteList[part.getLocation()].getSRNeighbours()) {
+					if (siteList[nb].isOccupied(PType::elec) || siteList[nb].isOccupied(PType::hole)) {
+						return false;
+					}
+				}
+			}
+			return true;
+		};
+
+		bool timeUp = false;
+		while (steps < maxSteps && !timeUp) {
+			long chunkEnd = std::min<long>(maxSteps, steps + options.dilute_epochSteps);
+			for (; steps < chunkEnd; ++steps) {
+				computeNextEventRates();
+				if (next_event_list.getNrOfEvents() == 0) {
+					return false;
+				}
+				double dt = random_engine.getInterArrivalTime(next_event_list.getTotalRate());
+				if (timeLimit > 0.0 && totalTime + dt >= timeLimit) {
+					totalTime = timeLimit;
+					timeUp = true;
+					break;
+				}
+				totalTime += dt;
+				std::tuple<Transition, int, int> nextEvent = next_event_list.getNextEvent(random_engine.getUniform01());
+				executeEvent(std::get<0>(nextEvent), std::get<1>(nextEvent), std::get<2>(nextEvent));
+			}
+			if (!unchanged()) {
+				return false;
+			}
+			if (separated()) {
+				break;
+			}
+		}
+
+		for (auto& walker : walkers) {
+			const Particle& part = particleList[walker.partID];
+			siteList[part.getLocation()].freeSite(part.getType(), totalTime);
+			walker.clock = totalTime;
+		}
+		return true;
+	};
+
+	std::vector<int> visitHead(siteList.size(), -1);
+	std::vector<Particle> snapshot;
+	std::vector<double> hopTimes;
+	long committedSteps = 0;
+	while (committedSteps < maxSteps && (timeLimit <= 0.0 || totalTime < timeLimit)) {
+		double epochEnd = totalTime + epochLength;
+		if (timeLimit > 0.0) {
+			epochEnd = std::min(epochEnd, timeLimit);
+		}
+		snapshot.clear();
+		for (const auto& walker : walkers) {
+			snapshot.push_back(particleList[walker.partID]);
+		}
+
+		pool.run(walkers.size(), [&](int w) { advanceWalker(walkers[w], epochEnd); });
+
+		/* Up to their first interaction the carriers were independent, so the epoch is cut there instead of redone.
+		   The hop at that time is kept, it was drawn while the carriers were still apart. */
+		double cut = epochEnd;
+		double meeting = firstInteraction(walkers, siteList, visitHead);
+		bool interacted = meeting < epochEnd;
+		if (interacted) {
+			diluteInteractingEpochs++;
+			if (options.dilute_fallback) {
+				cut = meeting;
+			}
+		}
+		/* Never more than maxSteps hops, the epoch is cut at the last hop allowed */
+		long epochSteps = 0;
+		for (const auto& walker : walkers) {
+			epochSteps += walker.steps;
+		}
+		if (committedSteps + epochSteps > maxSteps) {
+			hopTimes.clear();
+			for (const auto& walker : walkers) {
+				for (unsigned int v = 1; v < walker.visits.size(); ++v) {
+					hopTimes.push_back(walker.visits[v].tIn);
+				}
+			}
+			auto last = hopTimes.begin() + (maxSteps - committedSteps - 1);
+			std::nth_element(hopTimes.begin(), last, hopTimes.end());
+			cut = std::min(cut, *last);
+		}
+
+		/* Commit the epoch up to the cut, the carriers are moved back and replay their hops if the epoch was cut */
+		epochSteps = 0;
+		for (unsigned int w = 0; w < walkers.size(); ++w) {
+			DiluteWalker& walker = walkers[w];
+			Particle& part = particleList[walker.partID];
+			if (cut < epochEnd) {
+				part = snapshot[w];
+			}
+			PType type = part.getType();
+			for (unsigned int v = 0; v < walker.visits.size() && walker.visits[v].tIn <= cut; ++v) {
+				const Visit& visit = walker.visits[v];
+				siteList[visit.site].addOccupation(type, std::min(visit.tOut, cut) - visit.tIn);
+				if (v > 0) {
+					int from = walker.visits[v - 1].site;
+					if (cut < epochEnd) {
+						part.jumpTo(visit.site, pbc.dr_PBC_corrected(siteList[from].getCoordinates(), siteList[visit.site].getCoordinates()));
+					}
+					if (edgeFlux.isEnabled()) {
+						edgeFlux.recordHop(type, from, visit.site, siteList);
+					}
+					epochSteps++;
+				}
+			}
+			walker.clock = cut;
+		}
+		committedSteps += epochSteps;
+		transitionCounts[Transition::normalhop] += epochSteps;
+		totalTime = cut;
+
+		if (interacted && options.dilute_fallback) {
+			epochLength *= 0.5;
+			if (committedSteps < maxSteps && !runSerially(committedSteps)) {
+				log() << "\nCarriers interacted at t = " << totalTime << ", continuing with the serial event loop." << std::endl;
+				diluteFinished = true;
+				return committedSteps;
+			}
+		}
+		else {
+			epochLength *= std::clamp((double)options.dilute_epochSteps * walkers.size() / std::max(1L, epochSteps), 0.5, 2.0);
+		}
+	}
+
+	for (const auto& walker : walkers) {
+		const Particle& part = particleList[walker.partID];
+		siteList[part.getLocation()].setOccupied(part.getType(), walker.partID, totalTime);
+	}
+	return committedSteps;
+}
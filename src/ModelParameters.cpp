@@ -0,0 +1,71 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "ModelParameters.h"
+#include <fstream>
+#include <stdexcept>
+
+bool ModelParameters::readFromFile(const std::string& fileName) {
+	std::ifstream myfile(fileName);
+	if (!myfile.is_open()) {
+		return false;
+	}
+	read(myfile);
+	return true;
+}
+
+void ModelParameters::read(std::istream& myfile) {
+	/* Every line is a "key value" pair, the order does not matter */
+	std::string key, value;
+	while (myfile >> key) {
+		if (!(myfile >> value)) {
+			throw std::invalid_argument("Parameter without a value: " + key);
+		}
+		if (!set(key, value)) {
+			throw std::invalid_argument("Unknown parameter: " + key);
+		}
+	}
+}
+
+bool ModelParameters::set(const std::string& key, const std::string& value) {
+	const std::array<std::string, 4> typeNames = { "elec", "hole", "trip", "sing" };
+	try {
+		if (key == "SEED") SEED = std::stoi(value);
+		else if (key == "nrOfSteps") nrOfSteps = std::stoi(value);
+		else if (key == "sR_CutOff") sR_CutOff = std::stod(value);
+		else if (key == "lR_CutOff") lR_CutOff = std::stod(value);
+		else if (key == "Xmax") Xmax = std::stod(value);
+		else if (key == "Ymax") Ymax = std::stod(value);
+		else if (key == "Zmax") Zmax = std::stod(value);
+		else if (key == "kBT") kBT = std::stod(value);
+		else if (key == "E_Field") E_Field = std::stod(value);
+		else {
+			for (unsigned int i = 0; i < 4; ++i) {
+				if (key.rfind(typeNames[i] + "_", 0) != 0) {
+					continue;
+				}
+				std::string name = key.substr(typeNames[i].size() + 1);
+				if (name == "qt") qt[i] = std::stoi(value);
+				else if (name == "DOS_mu") DOS_mu[i] = std::stod(value);
+				else if (name == "DOS_sigma") DOS_sigma[i] = std::stod(value);
+				else if (name == "charge") charge[i] = std::stod(value);
+				else if (name == "v0") v0[i] = std::stod(value);
+				else if (name == "alpha") alpha[i] = std::stod(value);
+				else break;
+				return true;
+			}
+			return options.set(key, value);
+		}
+		return true;
+	}
+	catch (const std::logic_error&) { // std::stoi and std::stod throw invalid_argument or out_of_range
+		throw std::invalid_argument("Invalid value for parameter " + key + ": " + value);
+	}
+}
@@ -11,6 +11,7 @@
 
 #include "NextEventList.h"
 #include <iostream>
+#include <stdexcept>
 
 std::tuple<Transition, int, int> NextEventList::getNextEvent(double random01) const {
 	double cumSum = 0;
@@ -22,8 +23,7 @@ std::tuple<Transition, int, int> NextEventList::getNextEvent(double random01) co
             return std::tuple<Transition, int, int> {eventType[i], partList[i], newLocation[i]};
 		}
 	}
-    std::cout << "Next event could not be found\n";
-    exit(EXIT_FAILURE);
+    throw std::runtime_error("Next event could not be found");
 }
 
 void NextEventList::pushNextEvent(double rate, Transition eventtype, int part, int loc) {
@@ -40,8 +40,10 @@ void NextEventList::pushNextEvent(double rate, Transition eventtype, int part, i
 }
 
 void NextEventList::resizeVectors() {
-    maxSize = (int) std::floor(maxSize * 1.1);
-    std::cout << "Initial event list size was to small...\n" << "... vectors are resized to: " << maxSize << " elements.\n";
+    maxSize *= 2; // the list never shrinks, so with a changing number of particles it stops growing at the largest size needed
+    if (verbose) {
+        std::cout << "Initial event list size was to small...\n" << "... vectors are resized to: " << maxSize << " elements.\n";
+    }
     rateList.resize(maxSize);
     partList.resize(maxSize);
     newLocation.resize(maxSize);
@@ -1,30 +1,185 @@
 #include "OutputManager.h"
 #include <ctime>
+#include <random>
+#include <filesystem>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include "EnumNames.h"
 
+namespace {
+const std::array<std::string, 4> typeNames{ "elec", "hole", "trip", "sing" };
 
-void OutputManager::printSiteOccupations(std::vector<Site>& siteList, double totalTime) {
+/* Runtime check, std::endian needs C++20 */
+bool isLittleEndian() {
+	const uint16_t one = 1;
+	unsigned char firstByte;
+	std::memcpy(&firstByte, &one, 1);
+	return firstByte == 1;
+}
+
+double swapBytes(double value) {
+	unsigned char bytes[sizeof(double)];
+	std::memcpy(bytes, &value, sizeof(double));
+	std::reverse(bytes, bytes + sizeof(double));
+	std::memcpy(&value, bytes, sizeof(double));
+	return value;
+}
+}
+
+OutputManager::OutputManager(std::string id, int seed) : runID(id) {
+	if (runID.empty()) {
+		/* Time stamp to the second plus the seed and a random tag, so runs started in the same second do not collide */
+		struct tm * ltm;
+		time_t now = time(0);
+		ltm = localtime( &now);
+		std::random_device rd;
+		runID = str(boost::format("%04d%02d%02d_%02d%02d%02d_s%d_%08x") % (ltm->tm_year + 1900) % (ltm->tm_mon + 1) % ltm->tm_mday
+			% ltm->tm_hour % ltm->tm_min % ltm->tm_sec % seed % rd());
+	}
+}
+
+bool OutputManager::openFile(std::ofstream& outFile, const std::string& filename, std::ios_base::openmode mode) {
+	std::error_code ec;
+	std::filesystem::create_directories(outputPath, ec);
+	outFile.open(filename, mode);
+	if (!outFile.is_open()) {
+		std::cout << "Could not open output file: " << filename << std::endl;
+		return false;
+	}
+	return true;
+}
 
-	struct tm * ltm;
-	time_t now = time(0);
-	ltm = localtime( &now);
-	ltm->tm_mon = ltm->tm_mon + 1;
-	std::string filename = outputPath + str( boost::format("siteOcc_%02d%02d%02d%02d.txt") % ltm->tm_mon % ltm->tm_mday % ltm->tm_hour % ltm->tm_min) ;
+void OutputManager::printSiteOccupations(const std::vector<Site>& siteList, double totalTime) {
+	std::string filename = outputPath + "siteOcc_" + runID + ".txt";
 
 	std::ofstream outFile;
-	outFile.open(filename);
-	if (outFile.is_open()) {
+	if (openFile(outFile, filename)) {
 		for (auto& site : siteList) {
 			outFile << site.getEnergy(PType::elec) << " " << site.getOccupation(PType::elec, totalTime) / totalTime << " "
 				<< site.getEnergy(PType::hole) << " " << site.getOccupation(PType::hole, totalTime) / totalTime << " "
 				<< site.getEnergy(PType::trip) << " " << site.getOccupation(PType::trip, totalTime) / totalTime << " "
 				<< site.getEnergy(PType::sing) << " " << site.getOccupation(PType::sing, totalTime) / totalTime << "\n"; 
 		}
-		std::cout << "Site occupations were printed to:\n\t"<<  filename << "\n";
+		if (verbose) std::cout << "Site occupations were printed to:\n\t"<<  filename << "\n";
 	}
-	else {
-		std::cout << "Could not open output file: " << filename << std::endl;
+	outFile.close();
+}
+
+/* Layout of the binary file:
+	a text header of "key value" lines, starting with "KMC_COLUMNAR 1" and ending with "data",
+	padded with spaces to a multiple of 64 bytes (the line "header_bytes" gives its total size),
+	followed by the columns one after the other, each "rows" little endian float64 values.
+   With numpy: np.fromfile(f, dtype="<f8", offset=header_bytes).reshape(columns, rows) */
+void OutputManager::writeSiteOccupationsBinary(const std::vector<Site>& siteList, double totalTime) {
+	std::string filename = outputPath + "siteOcc_" + runID + ".bin";
+
+	std::vector<std::string> columns{ "x", "y", "z" };
+	for (const auto& name : typeNames) {
+		columns.push_back(name + "_energy");
+		columns.push_back(name + "_occupation");
+	}
+
+	std::string header = str(boost::format("KMC_COLUMNAR 1\nrun_id %s\nrows %d\ncolumns %d\ndtype float64\nbyte_order little\ntotal_time %.17g\n")
+		% runID % siteList.size() % columns.size() % totalTime);
+	for (const auto& name : columns) {
+		header += "column " + name + "\n";
 	}
+	/* The header size is part of the header, its line has a fixed width so it can be written last */
+	const std::string sizeKey = "header_bytes ";
+	const int sizeWidth = 12;
+	size_t size = header.size() + sizeKey.size() + sizeWidth + 1 + std::string("data\n").size();
+	size = (size + 63) / 64 * 64;
+	header += sizeKey + str(boost::format("%012d") % size) + "\n";
+	header += std::string(size - header.size() - 5, ' ');
+	header += "data\n";
+
+	std::ofstream outFile;
+	if (!openFile(outFile, filename, std::ios_base::out | std::ios_base::binary)) {
+		return;
+	}
+	outFile.write(header.data(), header.size());
+
+	std::vector<double> column(siteList.size());
+	const bool swap = !isLittleEndian();
+	auto writeColumn = [&](auto value) {
+		for (unsigned int i = 0; i < siteList.size(); ++i) {
+			column[i] = value(siteList[i]);
+		}
+		/* The file is little endian on every host */
+		if (swap) {
+			std::transform(column.begin(), column.end(), column.begin(), swapBytes);
+		}
+		outFile.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(double));
+	};
+	for (int d = 0; d < 3; ++d) {
+		writeColumn([d](const Site& site) { return site.getCoordinates()[d]; });
+	}
+	for (int t = 0; t < 4; ++t) {
+		PType type = PType(t);
+		writeColumn([type](const Site& site) { return site.getEnergy(type); });
+		writeColumn([type, totalTime](const Site& site) { return site.getOccupation(type, totalTime) / totalTime; });
+	}
+	if (verbose) std::cout << "Site occupations were written to:\n\t" << filename << "\n";
+	outFile.close();
+}
+
+EnergyHistogram OutputManager::computeHistogram(const std::vector<Site>& siteList, PType type, double totalTime, int nrOfBins) {
+	EnergyHistogram hist;
+	hist.nrOfSites.assign(nrOfBins, 0);
+	hist.occupation.assign(nrOfBins, 0.0);
+	if (siteList.empty() || nrOfBins <= 0) {
+		return hist;
+	}
+	auto [minSite, maxSite] = std::minmax_element(siteList.begin(), siteList.end(),
+		[type](const Site& a, const Site& b) { return a.getEnergy(type) < b.getEnergy(type); });
+	hist.eMin = minSite->getEnergy(type);
+	double eMax = maxSite->getEnergy(type);
+	hist.binWidth = (eMax > hist.eMin) ? (eMax - hist.eMin) / nrOfBins : 1.0;
+
+	for (const auto& site : siteList) {
+		int bin = std::min(nrOfBins - 1, int((site.getEnergy(type) - hist.eMin) / hist.binWidth));
+		hist.nrOfSites[bin]++;
+		if (totalTime > 0.0) {
+			hist.occupation[bin] += site.getOccupation(type, totalTime) / totalTime;
+		}
+	}
+	return hist;
+}
+
+void OutputManager::printOccupationHistograms(const std::vector<Site>& siteList, double totalTime, int nrOfBins) {
+	std::string filename = outputPath + "energyHist_" + runID + ".txt";
+
+	std::ofstream outFile;
+	if (!openFile(outFile, filename)) {
+		return;
+	}
+	outFile << "# run_id " << runID << "\n# total_time " << totalTime << "\n";
+	for (int t = 0; t < 4; ++t) {
+		EnergyHistogram hist = computeHistogram(siteList, PType(t), totalTime, nrOfBins);
+		outFile << "\n# type " << typeNames[t] << "\n# energy nrOfSites occupation\n";
+		for (int b = 0; b < nrOfBins; ++b) {
+			outFile << hist.eMin + (b + 0.5) * hist.binWidth << " " << hist.nrOfSites[b] << " " << hist.occupation[b] << "\n";
+		}
+	}
+	if (verbose) std::cout << "Occupation histograms were printed to:\n\t" << filename << "\n";
+	outFile.close();
+}
+
+void OutputManager::printNetFlux(const EdgeFlux& edgeFlux, const std::vector<Site>& siteList) {
+	std::string filename = outputPath + "netFlux_" + runID + ".txt";
+
+	std::ofstream outFile;
+	if (!openFile(outFile, filename)) {
+		return;
+	}
+	outFile << "# run_id " << runID << "\n# type from to net (hops from -> to minus hops to -> from)\n";
+	long pairs = 0;
+	edgeFlux.forEachNetFlux(siteList, [&](PType type, int from, int to, long net) {
+		outFile << typeNames[type] << " " << from << " " << to << " " << net << "\n";
+		pairs++;
+	});
+	if (verbose) std::cout << "Net flux of " << pairs << " site pairs was printed to:\n\t" << filename << "\n";
 	outFile.close();
 }
 
@@ -49,4 +204,4 @@ void OutputManager::printParticleInfo(std::vector<Particle>& particleList){
 	}
 	std::cout << std::endl;
 
-}
\ No newline at end of file
+}
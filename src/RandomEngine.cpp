@@ -14,4 +14,11 @@ void RandomEngine::initializeParameters(std::array<double, 4> mu, std::array<dou
 	for (unsigned int i = 0; i < mu.size(); ++i) {
 		dos[i] = std::normal_distribution<double>{ mu[i], sigma[i] };
 	}
-}
\ No newline at end of file
+}
+
+RandomEngine RandomEngine::makeStream(int streamID) const {
+	RandomEngine stream(*this);
+	std::seed_seq seq{ seed, streamID };
+	stream.rng = std::mt19937_64(seq);
+	return stream;
+}
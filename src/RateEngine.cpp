@@ -23,10 +23,10 @@ double RateEngine::millerAbrahams(const Site& siteOne, const Site& siteTwo, cons
     double deltaE = siteTwo.getEnergy(type) - siteOne.getEnergy(type) + E_Field * charge[type] * dr[0];
 
     if ( deltaE <= 0) {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist));
+        return(v0[type] * exponential(-2 * alpha[type] * dist));
     }
     else {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist - deltaE / kBT));
+        return(v0[type] * exponential(-2 * alpha[type] * dist - deltaE / kBT));
     }
 } 
 
@@ -36,10 +36,10 @@ double RateEngine::millerAbrahamsGEN(const Site& siteOne, const Site& siteTwo, c
     double deltaE = siteTwo.getEnergy(type) - siteOne.getEnergy(type) + E_Field * charge[type] * dr[0] - deltaE_binding;
 
     if (deltaE <= 0) {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist));
+        return(v0[type] * exponential(-2 * alpha[type] * dist));
     }
     else {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist - deltaE / kBT));
+        return(v0[type] * exponential(-2 * alpha[type] * dist - deltaE / kBT));
     }
 }
 
@@ -49,10 +49,10 @@ double RateEngine::millerAbrahamsDIS(const Site& siteOne, const Site& siteTwo, c
     double deltaE = siteTwo.getEnergy(type) - siteOne.getEnergy(type) + E_Field * charge[type] * dr[0] + deltaE_binding;
 
     if (deltaE <= 0) {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist));
+        return(v0[type] * exponential(-2 * alpha[type] * dist));
     }
     else {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist - deltaE / kBT));
+        return(v0[type] * exponential(-2 * alpha[type] * dist - deltaE / kBT));
     }
 }
 
@@ -62,10 +62,10 @@ double RateEngine::millerAbrahamsCT_DIS(const Site& siteOne, const Site& siteTwo
     double deltaE = siteTwo.getEnergy(type) - siteOne.getEnergy(type) + E_Field * charge[type] * dr[0] + deltaE_CTbinding;
 
     if (deltaE <= 0) {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist));
+        return(v0[type] * exponential(-2 * alpha[type] * dist));
     }
     else {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist - deltaE / kBT));
+        return(v0[type] * exponential(-2 * alpha[type] * dist - deltaE / kBT));
     }
 }
 
@@ -75,10 +75,10 @@ double RateEngine::millerAbrahamsCT(const Site& siteOne, const Site& siteTwo, co
     double deltaE = siteTwo.getEnergy(type) - siteOne.getEnergy(type) + E_Field * charge[type] * dr[0] + deltaE_SingtoCT;
 
     if (deltaE <= 0) {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist));
+        return(v0[type] * exponential(-2 * alpha[type] * dist));
     }
     else {
-        return(v0[type] * std::exp(-2 * alpha[type] * dist - deltaE / kBT));
+        return(v0[type] * exponential(-2 * alpha[type] * dist - deltaE / kBT));
     }
 }
 
@@ -88,10 +88,10 @@ double RateEngine::forster(const Site& siteOne, const Site& siteTwo) const {
     double deltaE = siteTwo.getEnergy(PType::sing) - siteOne.getEnergy(PType::sing) + E_Field * charge[PType::sing] * dr[0];
 
     if (deltaE <= 0) {
-        return( v0[PType::sing] * std::pow(R_forster / dist, 6));
+        return( v0[PType::sing] * forsterFactor(dist));
     }
     else {
-        return( v0[PType::sing] * std::pow( R_forster/ dist, 6) * std::exp( - deltaE / kBT) );
+        return( v0[PType::sing] * forsterFactor(dist) * exponential( - deltaE / kBT) );
     }
 }
 
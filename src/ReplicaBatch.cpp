@@ -0,0 +1,253 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "ReplicaBatch.h"
+#include "CellList.h"
+#include "FastMath.h"
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+template <int Lanes>
+ReplicaBatch<Lanes>::ReplicaBatch(const ModelParameters& params, const std::vector<Eigen::Vector3d>& coordinates, PType type, int firstReplica) :
+	rate_engine(params.v0, params.alpha, params.charge, params.E_Field, params.kBT, PBC(params.Xmax, params.Ymax, params.Zmax)),
+	pbc(params.Xmax, params.Ymax, params.Zmax), type(type) {
+
+	rate_engine.setFastMath(params.options.fast_math);
+	int nrOfSites = coordinates.size();
+	int nrOfCarriers = params.qt[type];
+	if (type != PType::elec && type != PType::hole) {
+		throw std::invalid_argument("ReplicaBatch only supports electrons or holes.");
+	}
+	if (nrOfCarriers > nrOfSites) {
+		throw std::invalid_argument("ReplicaBatch: more carriers than sites.");
+	}
+
+	/* Hops of the shared geometry */
+	CellList cellList(pbc, params.sR_CutOff);
+	for (const auto& coord : coordinates) {
+		cellList.addSite(coord);
+	}
+	edgeOffset.push_back(0);
+	for (int i = 0; i < nrOfSites; ++i) {
+		std::vector<int> neighbours = cellList.sitesWithin(coordinates[i], params.sR_CutOff, i);
+		std::sort(neighbours.begin(), neighbours.end());
+		for (const auto& nb : neighbours) {
+			Eigen::Vector3d dr = pbc.dr_PBC_corrected(coordinates[i], coordinates[nb]);
+			edgeTarget.push_back(nb);
+			edgePrefactor.push_back(rate_engine.millerAbrahamsPrefactor(dr.norm(), type));
+			edgeField.push_back(rate_engine.fieldEnergy(-dr[0], type));
+			edgeDr.push_back(dr);
+		}
+		edgeOffset.push_back(edgeTarget.size());
+	}
+
+	/* Energies and initial positions of every lane */
+	energy.resize(nrOfSites);
+	vacant.assign(nrOfSites, LaneDouble::Ones());
+	carrierAt.assign(nrOfSites, LaneInt::Constant(-1));
+	occupation.assign(nrOfSites, LaneDouble::Zero());
+	location.resize(nrOfCarriers);
+	occupiedSince.assign(nrOfCarriers, LaneDouble::Zero());
+	RandomEngine seedEngine(params.SEED, params.DOS_mu, params.DOS_sigma);
+	for (int l = 0; l < Lanes; ++l) {
+		streams.push_back(seedEngine.makeStream(firstReplica + l));
+		RandomEngine& rng = streams.back();
+		rng.setNrOfSites(nrOfSites);
+		for (int s = 0; s < nrOfSites; ++s) {
+			energy[s][l] = rng.getDOSEnergy(type);
+		}
+		for (int c = 0; c < nrOfCarriers; ++c) {
+			int site = rng.getRandomSite();
+			while (vacant[site][l] == 0.0) { // get a unique location
+				site = rng.getRandomSite();
+			}
+			vacant[site][l] = 0.0;
+			carrierAt[site][l] = c;
+			location[c][l] = site;
+		}
+		displacement[l].setZero();
+	}
+	carrierRates.resize(nrOfCarriers);
+	carrierTotal.assign(nrOfCarriers, LaneDouble::Zero());
+	dirty.assign(nrOfCarriers, true);
+}
+
+template <int Lanes>
+long ReplicaBatch<Lanes>::runSteps(long n) {
+	long step = 0;
+	for (; step < n; ++step) {
+		if (!this->step()) {
+			break;
+		}
+	}
+	return step;
+}
+
+template <int Lanes>
+long ReplicaBatch<Lanes>::runUntil(double time) {
+	timeLimit = time;
+	for (int l = 0; l < Lanes; ++l) {
+		finished[l] = clock[l] >= time;
+	}
+	long steps = runSteps(std::numeric_limits<long>::max());
+	timeLimit = 0.0;
+	return steps;
+}
+
+template <int Lanes>
+void ReplicaBatch<Lanes>::computeCarrierRates(int carrier) {
+	/* The carrier sits on a different site in every lane, so the edges are gathered per lane and the rates computed for all lanes at once */
+	const LaneInt& loc = location[carrier];
+	const double kBT = rate_engine.getkBT();
+	const bool fastMath = rate_engine.getFastMath();
+	int maxDegree = 0;
+	for (int l = 0; l < Lanes; ++l) {
+		maxDegree = std::max(maxDegree, edgeOffset[loc[l] + 1] - edgeOffset[loc[l]]);
+	}
+	std::vector<LaneDouble>& rates = carrierRates[carrier];
+	rates.resize(maxDegree);
+	LaneDouble total = LaneDouble::Zero();
+	for (int k = 0; k < maxDegree; ++k) {
+		LaneDouble prefactor, deltaE;
+		for (int l = 0; l < Lanes; ++l) {
+			int site = loc[l];
+			int e = edgeOffset[site] + k;
+			if (e < edgeOffset[site + 1]) {
+				int target = edgeTarget[e];
+				prefactor[l] = edgePrefactor[e] * vacant[target][l];
+				deltaE[l] = energy[target][l] - energy[site][l] + edgeField[e];
+			}
+			else {
+				prefactor[l] = 0.0;
+				deltaE[l] = 0.0;
+			}
+		}
+		LaneDouble exponent = -deltaE.max(0.0) / kBT;
+		if (fastMath) { // FastMath::exp has no vector form, it is applied per lane
+			rates[k] = prefactor * exponent.unaryExpr([](double x) { return FastMath::exp(x); });
+		}
+		else {
+			rates[k] = prefactor * exponent.exp();
+		}
+		total += rates[k];
+	}
+	carrierTotal[carrier] = total;
+	dirty[carrier] = false;
+}
+
+template <int Lanes>
+bool ReplicaBatch<Lanes>::step() {
+	if (std::all_of(finished.begin(), finished.end(), [](bool f) { return f; })) {
+		return false;
+	}
+
+	LaneDouble totalRate = LaneDouble::Zero();
+	for (unsigned int c = 0; c < location.size(); ++c) {
+		if (dirty[c]) {
+			computeCarrierRates(c);
+		}
+		totalRate += carrierTotal[c];
+	}
+
+	/* Time step and selection, every lane uses its own stream (in the same order as KmcRun) */
+	LaneDouble dt, select;
+	for (int l = 0; l < Lanes; ++l) {
+		if (finished[l] || totalRate[l] <= 0.0) {
+			finished[l] = true;
+			dt[l] = 0.0;
+			select[l] = std::numeric_limits<double>::infinity();
+			continue;
+		}
+		dt[l] = streams[l].getInterArrivalTime(totalRate[l]);
+		select[l] = (1.0 - streams[l].getUniform01()) * totalRate[l]; // in (0, totalRate], never selects a zero rate
+		if (timeLimit > 0.0 && clock[l] + dt[l] >= timeLimit) { // the remaining waiting time falls beyond the end of the run
+			clock[l] = timeLimit;
+			finished[l] = true;
+		}
+	}
+
+	/* The selected carrier of a lane is the number of carriers whose cumulative rate is below its selection value */
+	LaneDouble cumSum = LaneDouble::Zero();
+	LaneInt selected = LaneInt::Zero();
+	for (const auto& total : carrierTotal) {
+		cumSum += total;
+		selected += (cumSum < select).template cast<int>();
+	}
+
+	for (int l = 0; l < Lanes; ++l) {
+		if (finished[l]) {
+			continue;
+		}
+		int c = selected[l];
+		if (c >= (int)carrierTotal.size()) { // rounding, take the last possible carrier
+			c = carrierTotal.size() - 1;
+			while (carrierTotal[c][l] <= 0.0) --c;
+		}
+		double remaining = select[l];
+		for (int i = 0; i < c; ++i) {
+			remaining -= carrierTotal[i][l];
+		}
+		const std::vector<LaneDouble>& rates = carrierRates[c];
+		int from = location[c][l];
+		int degree = edgeOffset[from + 1] - edgeOffset[from];
+		int k = 0, last = 0;
+		double cum = 0.0;
+		for (; k < degree; ++k) {
+			if (rates[k][l] <= 0.0) continue;
+			last = k;
+			cum += rates[k][l];
+			if (cum >= remaining) break;
+		}
+		if (k == degree) { // rounding
+			k = last;
+		}
+		int e = edgeOffset[from] + k;
+		int to = edgeTarget[e];
+
+		clock[l] += dt[l];
+		occupation[from][l] += clock[l] - occupiedSince[c][l];
+		occupiedSince[c][l] = clock[l];
+		vacant[from][l] = 1.0;
+		vacant[to][l] = 0.0;
+		carrierAt[from][l] = -1;
+		carrierAt[to][l] = c;
+		location[c][l] = to;
+		displacement[l] += edgeDr[e];
+		hops[l]++;
+
+		/* The rates of the carrier itself and of the carriers next to both sites changed */
+		dirty[c] = true;
+		for (int site : { from, to }) {
+			for (int f = edgeOffset[site]; f < edgeOffset[site + 1]; ++f) {
+				int other = carrierAt[edgeTarget[f]][l];
+				if (other >= 0) {
+					dirty[other] = true;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+template <int Lanes>
+double ReplicaBatch<Lanes>::getOccupation(int site, int lane) const {
+	double occ = occupation[site][lane];
+	for (unsigned int c = 0; c < location.size(); ++c) {
+		if (location[c][lane] == site) {
+			occ += clock[lane] - occupiedSince[c][lane];
+		}
+	}
+	return occ;
+}
+
+template class ReplicaBatch<4>;
+template class ReplicaBatch<8>;
@@ -0,0 +1,136 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "RunOptions.h"
+#include <stdexcept>
+
+bool RunOptions::set(const std::string& key, const std::string& value) {
+	if (key == "superbasin") {
+		superbasin = std::stoi(value) != 0;
+	}
+	else if (key == "superbasin_history") {
+		superbasin_history = std::stoi(value);
+	}
+	else if (key == "superbasin_maxSites") {
+		superbasin_maxSites = std::stoi(value);
+	}
+	else if (key == "dilute") {
+		dilute = std::stoi(value) != 0;
+	}
+	else if (key == "dilute_fallback") {
+		dilute_fallback = std::stoi(value) != 0;
+	}
+	else if (key == "dilute_epochSteps") {
+		dilute_epochSteps = std::stoi(value);
+	}
+	else if (key == "dilute_threads") {
+		dilute_threads = std::stoi(value);
+	}
+	else if (key == "batch") {
+		batch = std::stoi(value) != 0;
+	}
+	else if (key == "batch_window") {
+		batch_window = std::stod(value);
+	}
+	else if (key == "batch_threads") {
+		batch_threads = std::stoi(value);
+	}
+	else if (key == "lR_pruneFraction") {
+		lR_pruneFraction = std::stod(value);
+	}
+	else if (key == "lR_cacheSize") {
+		lR_cacheSize = std::stoi(value);
+	}
+	else if (key == "edge_flux") {
+		if (value != "none" && value != "dense" && value != "sparse" && value != "auto") {
+			throw std::invalid_argument("Unknown edge_flux: " + value);
+		}
+		edge_flux = value;
+	}
+	else if (key == "telemetry") {
+		telemetry = value;
+	}
+	else if (key == "telemetry_interval") {
+		telemetry_interval = std::stod(value);
+	}
+	else if (key == "disorder") {
+		if (value != "gaussian" && value != "dipolar") {
+			throw std::invalid_argument("Unknown disorder: " + value);
+		}
+		disorder = value;
+	}
+	else if (key == "disorder_cutOff") {
+		disorder_cutOff = std::stod(value);
+	}
+	else if (key == "disorder_threads") {
+		disorder_threads = std::stoi(value);
+	}
+	else if (key == "initial_placement") {
+		if (value != "uniform" && value != "equilibrium") {
+			throw std::invalid_argument("Unknown initial_placement: " + value);
+		}
+		initial_placement = value;
+	}
+	else if (key == "warmup_steps") {
+		warmup_steps = std::stol(value);
+	}
+	else if (key == "specialize_types") {
+		specialize_types = std::stoi(value) != 0;
+	}
+	else if (key == "fast_math") {
+		fast_math = std::stoi(value) != 0;
+	}
+	else if (key == "electrodes") {
+		electrodes = std::stoi(value) != 0;
+	}
+	else if (key == "electrode_carrier") {
+		if (value != "auto" && value != "elec" && value != "hole") {
+			throw std::invalid_argument("Unknown electrode_carrier: " + value);
+		}
+		electrode_carrier = value;
+	}
+	else if (key == "electrode_range") {
+		electrode_range = std::stod(value);
+	}
+	else if (key == "electrode_barrierLeft") {
+		electrode_barrierLeft = std::stod(value);
+	}
+	else if (key == "electrode_barrierRight") {
+		electrode_barrierRight = std::stod(value);
+	}
+	else if (key == "max_time") {
+		max_time = std::stod(value);
+	}
+	else if (key == "verbose") {
+		verbose = std::stoi(value) != 0;
+	}
+	else if (key == "write_output") {
+		write_output = std::stoi(value) != 0;
+	}
+	else if (key == "output_format") {
+		if (value != "text" && value != "binary" && value != "none") {
+			throw std::invalid_argument("Unknown output_format: " + value);
+		}
+		output_format = value;
+	}
+	else if (key == "output_histogramBins") {
+		output_histogramBins = std::stoi(value);
+	}
+	else if (key == "run_id") {
+		run_id = value;
+	}
+	else if (key == "record_waitingTimes") {
+		record_waitingTimes = std::stoi(value) != 0;
+	}
+	else {
+		return false; // the caller reports the unknown key
+	}
+	return true;
+}
@@ -0,0 +1,54 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "Superbasin.h"
+#include <algorithm>
+
+void Superbasin::recordHop(int site, int historyLength) {
+	if ((int)history.size() < historyLength) {
+		history.push_back(site);
+	}
+	else {
+		history[histPos] = site;
+		histPos = (histPos + 1) % historyLength;
+	}
+}
+
+bool Superbasin::detect(int maxSites, int historyLength, int entry, double time) {
+	if ((int)history.size() < historyLength) {
+		return false;
+	}
+	basinSites.clear();
+	basinSites.push_back(entry);
+	for (const auto& site : history) {
+		if (std::find(basinSites.begin(), basinSites.end(), site) == basinSites.end()) {
+			basinSites.push_back(site);
+			if ((int)basinSites.size() > maxSites) {
+				basinSites.clear();
+				return false;
+			}
+		}
+	}
+	if (basinSites.size() < 2) {
+		basinSites.clear();
+		return false;
+	}
+	active = true;
+	entrySite = entry;
+	entryTime = time;
+	return true;
+}
+
+int Superbasin::indexOf(int site) const {
+	for (unsigned int j = 0; j < basinSites.size(); ++j) {
+		if (basinSites[j] == site) return j;
+	}
+	return -1;
+}
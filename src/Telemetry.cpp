@@ -0,0 +1,144 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "Telemetry.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <boost/format.hpp>
+#ifdef __unix__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+Telemetry::Telemetry(std::string target, double interval, std::string runID) :
+	target(target), interval(interval > 0.0 ? interval : 1.0), runID(runID), startTime(std::chrono::steady_clock::now()) {
+
+	if (target.rfind("unix:", 0) == 0) {
+		socketPath = target.substr(5);
+		connectSocket();
+	}
+	else {
+		file.open(target, std::ios_base::app);
+		if (!file.is_open()) {
+			std::cout << "Could not open telemetry file: " << target << std::endl;
+		}
+	}
+	worker = std::thread(&Telemetry::run, this);
+}
+
+Telemetry::~Telemetry() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	worker.join();
+#ifdef __unix__
+	if (socketFd >= 0) {
+		close(socketFd);
+	}
+#endif
+}
+
+void Telemetry::run() {
+	long lastSteps = 0;
+	auto lastTime = startTime;
+	while (true) {
+		bool stop;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			stop = wake.wait_for(lock, interval, [this]() { return stopping; });
+		}
+		/* Written without the lock, so a slow reader never blocks the simulation thread */
+		write(sample(lastSteps, lastTime));
+		if (stop) {
+			return;
+		}
+	}
+}
+
+void Telemetry::restartSteps() {
+	restartWallTime.store(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count(), std::memory_order_relaxed);
+	steps.store(0, std::memory_order_relaxed);
+}
+
+std::string Telemetry::sample(long& lastSteps, std::chrono::steady_clock::time_point& lastTime) {
+	auto now = std::chrono::steady_clock::now();
+	long nrOfSteps = steps.load(std::memory_order_relaxed);
+	double time = simulatedTime.load(std::memory_order_relaxed);
+	double elapsed = std::chrono::duration<double>(now - startTime).count();
+	double sinceLast = std::chrono::duration<double>(now - lastTime).count();
+	if (nrOfSteps < lastSteps) {
+		lastSteps = 0; // the steps were restarted since the last sample
+	}
+	double eventsPerSecond = (sinceLast > 0.0) ? (nrOfSteps - lastSteps) / sinceLast : 0.0;
+	lastSteps = nrOfSteps;
+	lastTime = now;
+
+	/* Progress is the furthest of the step and time targets, the estimate assumes the average speed so far */
+	double progress = 0.0;
+	long stepTarget = targetSteps.load(std::memory_order_relaxed);
+	double timeTarget = targetTime.load(std::memory_order_relaxed);
+	if (stepTarget > 0) progress = std::max(progress, (double)nrOfSteps / stepTarget);
+	if (timeTarget > 0.0) progress = std::max(progress, time / timeTarget);
+	progress = std::min(progress, 1.0);
+	double counted = elapsed - restartWallTime.load(std::memory_order_relaxed);
+	std::string eta = (progress > 0.0) ? str(boost::format("%.1f") % (counted * (1.0 - progress) / progress)) : "null";
+
+	return str(boost::format("{\"run_id\": \"%s\", \"wall_time\": %.3f, \"steps\": %d, \"events_per_s\": %.1f, \"simulated_time\": %.6e, "
+		"\"total_rate\": %.6e, \"event_list_length\": %d, \"population\": {\"elec\": %d, \"hole\": %d, \"trip\": %d, \"sing\": %d, \"CT\": %d}, "
+		"\"progress\": %.4f, \"eta_s\": %s}\n")
+		% runID % elapsed % nrOfSteps % eventsPerSecond % time % totalRate.load(std::memory_order_relaxed) % eventListLength.load(std::memory_order_relaxed)
+		% population[PType::elec].load(std::memory_order_relaxed) % population[PType::hole].load(std::memory_order_relaxed)
+		% population[PType::trip].load(std::memory_order_relaxed) % population[PType::sing].load(std::memory_order_relaxed)
+		% population[PType::CT].load(std::memory_order_relaxed) % progress % eta);
+}
+
+bool Telemetry::connectSocket() {
+#ifdef __unix__
+	socketFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+	if (socketFd < 0 || connect(socketFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+		if (socketFd >= 0) {
+			close(socketFd);
+		}
+		socketFd = -1;
+		return false;
+	}
+	return true;
+#else
+	std::cout << "Telemetry over a Unix socket is not supported on this platform." << std::endl;
+	return false;
+#endif
+}
+
+void Telemetry::write(const std::string& line) {
+	if (!socketPath.empty()) {
+#ifdef __unix__
+		/* The listener may start later or restart, so a lost connection is retried at every sample */
+		if (socketFd < 0 && !connectSocket()) {
+			return;
+		}
+		/* A reader that does not keep up loses samples instead of stalling the run at its end */
+		if (send(socketFd, line.data(), line.size(), MSG_NOSIGNAL | MSG_DONTWAIT) < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+			close(socketFd);
+			socketFd = -1;
+		}
+#endif
+	}
+	else if (file.is_open()) {
+		file << line << std::flush;
+	}
+}
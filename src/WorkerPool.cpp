@@ -0,0 +1,77 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ **************************************************/
+
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned int nrOfThreads) {
+	for (unsigned int id = 1; id < nrOfThreads; ++id) {
+		workers.emplace_back(&WorkerPool::workerLoop, this, id);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+void WorkerPool::run(int count, const std::function<void(int)>& work) {
+	unsigned int nrOfThreads = std::min<unsigned int>(getNrOfThreads(), count);
+	if (nrOfThreads <= 1) {
+		for (int i = 0; i < count; ++i) work(i);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &work;
+		jobCount = count;
+		jobThreads = nrOfThreads;
+		busy = nrOfThreads - 1;
+		generation++;
+	}
+	wake.notify_all();
+	for (int i = 0; i < count; i += nrOfThreads) work(i);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [&]() { return busy == 0; });
+	job = nullptr;
+}
+
+void WorkerPool::workerLoop(unsigned int id) {
+	long done = 0;
+	while (true) {
+		std::unique_lock<std::mutex> lock(mutex);
+		wake.wait(lock, [&]() { return stopping || generation != done; });
+		if (stopping) {
+			return;
+		}
+		done = generation;
+		if (id >= jobThreads) {
+			continue; // not needed for this job
+		}
+		const std::function<void(int)>& work = *job;
+		int count = jobCount;
+		unsigned int stride = jobThreads;
+		lock.unlock();
+
+		for (int i = id; i < count; i += stride) work(i);
+
+		lock.lock();
+		if (--busy == 0) {
+			finished.notify_one();
+		}
+	}
+}
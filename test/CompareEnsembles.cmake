@@ -0,0 +1,41 @@
+# Runs the same ensemble sweep on 1 and on NP ranks and fails unless the result files are identical,
+# the results must not depend on the number of ranks or on which rank ran which replica.
+# Usage: cmake -DMPIEXEC=... -DNP_FLAG=... -DNP=3 -DDRIVER=... -DREPLICAS=4 -DSWEEP=... -DPARAMS=... -DSITES=... -DWORK_DIR=... -P CompareEnsembles.cmake
+
+foreach(ranks 1 ${NP})
+    set(dir ${WORK_DIR}/np${ranks})
+    file(REMOVE_RECURSE ${dir})
+    file(MAKE_DIRECTORY ${dir})
+    execute_process(COMMAND ${MPIEXEC} ${NP_FLAG} ${ranks} ${DRIVER} ${REPLICAS} ${SWEEP} ${PARAMS} ${SITES} ${dir}
+        WORKING_DIRECTORY ${dir} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "KMC_mpi on ${ranks} ranks failed: ${result}")
+    endif()
+endforeach()
+
+# The run IDs differ between the runs, the files are matched by what follows the run ID
+file(GLOB reference RELATIVE ${WORK_DIR}/np1 ${WORK_DIR}/np1/ensemble_*.txt)
+file(GLOB candidate RELATIVE ${WORK_DIR}/np${NP} ${WORK_DIR}/np${NP}/ensemble_*.txt)
+list(LENGTH reference nrOfFiles)
+list(LENGTH candidate nrOfCandidates)
+if(nrOfFiles EQUAL 0 OR NOT nrOfFiles EQUAL nrOfCandidates)
+    message(FATAL_ERROR "Expected the same result files for 1 and ${NP} ranks, got ${nrOfFiles} and ${nrOfCandidates}")
+endif()
+foreach(file ${reference})
+    string(REGEX REPLACE "^ensemble_.*_(summary|occ_p[0-9]+)\\.txt$" "\\1" kind ${file})
+    set(match "")
+    foreach(other ${candidate})
+        if(other MATCHES "_${kind}\\.txt$")
+            set(match ${other})
+        endif()
+    endforeach()
+    if(match STREQUAL "")
+        message(FATAL_ERROR "No ${kind} file for ${NP} ranks")
+    endif()
+    file(STRINGS ${WORK_DIR}/np1/${file} lines REGEX "^[^#]")
+    file(STRINGS ${WORK_DIR}/np${NP}/${match} otherLines REGEX "^[^#]")
+    if(NOT lines STREQUAL otherLines)
+        message(FATAL_ERROR "The ${kind} results of 1 and ${NP} ranks differ: ${file} and ${match}")
+    endif()
+endforeach()
+message(STATUS "${nrOfFiles} result files are identical for 1 and ${NP} ranks")
@@ -0,0 +1,520 @@
+/***************************************************
+ *
+ * KMC MODEL FOR OPTOELECTRIC PROCESSES
+ *
+ * Author: Ruben Gerritsen
+ *
+ * Created on 19-10-2026
+ *
+ * Statistical equivalence tests. Every candidate
+ * engine (an accelerated, parallel or approximate
+ * mode of KmcRun) is run next to the reference event
+ * loop on small generated morphologies. Both are run
+ * up to the same simulated time for a set of fixed
+ * seeds, then the waiting times, transition counts,
+ * site occupations and particle yields are compared
+ * with Kolmogorov-Smirnov and Welch t-tests. The
+ * p-values of one candidate are Holm corrected for
+ * the number of observables.
+ *
+ * The program returns a non-zero exit code if any
+ * candidate diverges from the reference, or if the
+ * deliberately perturbed control is NOT detected.
+ **************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <boost/format.hpp>
+#include <boost/math/distributions/students_t.hpp>
+#include "KmcRun.h"
+#include "RunOptions.h"
+#include "ReplicaBatch.h"
+
+namespace {
+
+const double alpha = 1e-3; // family-wise significance level of all observables of one candidate in one scenario
+const int nrOfReplicas = 24;
+const int nrOfSites = 300;
+const double boxSize = 40.0;
+const double sR_cutOff = 12.0;
+const double lR_cutOff = 16.0;
+
+struct Scenario {
+	std::string name;
+	std::array<int, 4> qt;
+	double kBT;
+	double maxTime;
+	std::array<double, 4> v0;
+	double chargeSigma = 0.052; // width of the electron and hole DOS
+};
+
+struct RunResult {
+	std::array<long, nrOfTransitions> counts;
+	std::vector<double> waitingTimes;
+	std::array<double, 4> meanEnergy; // time averaged energy of the occupied sites
+	std::array<double, 4> deepOccupation; // fraction of the occupation on the 10% deepest sites
+	std::array<int, 5> alive{ 0 };
+	std::array<int, 5> dead{ 0 };
+};
+
+struct Candidate {
+	std::string name;
+	std::function<void(RunOptions&)> configure;
+	bool compareWaitingTimes; // only meaningful if the candidate executes the same event sequence
+	bool compareHops; // false if the candidate skips or merges normal hops
+	std::vector<std::string> scenarios;
+	bool expectEquivalent = true;
+	double kBTFactor = 1.0; // used to perturb the physics of the control candidate
+	/* Engines that are not a mode of KmcRun produce all replicas at once */
+	std::function<std::vector<RunResult>(const std::vector<Eigen::Vector3d>&, const Scenario&)> runAll = nullptr;
+};
+
+struct Sample {
+	std::vector<double> reference;
+	std::vector<double> candidate;
+};
+
+std::vector<Eigen::Vector3d> makeMorphology() {
+	std::mt19937_64 rng(2020);
+	std::uniform_real_distribution<double> coord(0.0, boxSize);
+	std::vector<Eigen::Vector3d> coordinates;
+	for (int i = 0; i < nrOfSites; ++i) {
+		double x = coord(rng), y = coord(rng), z = coord(rng);
+		coordinates.emplace_back(x, y, z);
+	}
+	return coordinates;
+}
+
+RunResult runOnce(const std::vector<Eigen::Vector3d>& morphology, const Scenario& scenario, const Candidate* candidate, int seed) {
+	std::array<double, 4> alphaLoc{ 0.15, 0.15, 0.15, 0.15 };
+	std::array<double, 4> charge{ -1.0, 1.0, 0.0, 0.0 };
+	std::array<double, 4> mu{ 1.5, 1.5, 1.5, 1.5 };
+	std::array<double, 4> sigma{ scenario.chargeSigma, scenario.chargeSigma, 0.026, 0.026 };
+	double kBT = scenario.kBT * (candidate ? candidate->kBTFactor : 1.0);
+
+	RunOptions options;
+	options.max_time = scenario.maxTime;
+	options.write_output = false;
+	options.verbose = false;
+	options.record_waitingTimes = true;
+	options.fast_math = false; // the reference always uses the exact rates
+	if (candidate) {
+		candidate->configure(options);
+	}
+
+	PBC pbc(boxSize, boxSize, boxSize);
+	RateEngine rate_engine(scenario.v0, alphaLoc, charge, 0.0, kBT, pbc);
+	RandomEngine random_engine(seed);
+	random_engine.initializeParameters(mu, sigma);
+
+	KmcRun run{ rate_engine, pbc, random_engine, 1000000000, scenario.qt, "", sR_cutOff, lR_cutOff, options };
+	run.setSites(morphology);
+	run.runSimulation();
+
+	RunResult result;
+	result.counts = run.getTransitionCounts();
+	result.waitingTimes = run.getWaitingTimes();
+	const std::vector<Site>& sites = run.getSites();
+	for (int t = 0; t < 4; ++t) {
+		PType type = PType(t);
+		std::vector<double> energies;
+		for (const auto& site : sites) {
+			energies.push_back(site.getEnergy(type));
+		}
+		std::nth_element(energies.begin(), energies.begin() + energies.size() / 10, energies.end());
+		double deepEnergy = energies[energies.size() / 10];
+
+		double occupation = 0.0, energy = 0.0, deep = 0.0;
+		for (const auto& site : sites) {
+			double occ = site.getOccupation(type, run.getTotalTime());
+			occupation += occ;
+			energy += occ * site.getEnergy(type);
+			if (site.getEnergy(type) <= deepEnergy) {
+				deep += occ;
+			}
+		}
+		result.meanEnergy[t] = occupation > 0.0 ? energy / occupation : NAN;
+		result.deepOccupation[t] = occupation > 0.0 ? deep / occupation : NAN;
+	}
+	for (const auto& part : run.getParticles()) {
+		if (part.isAlive()) {
+			result.alive[part.getType()]++;
+		}
+		else {
+			result.dead[part.getType()]++;
+		}
+	}
+	return result;
+}
+
+/* Same observables as runOnce() for the electrons of ReplicaBatch, all replicas in lockstep */
+std::vector<RunResult> runReplicaBatch(const std::vector<Eigen::Vector3d>& morphology, const Scenario& scenario, bool fastMath) {
+	const int lanes = ReplicaBatch<8>::getNrOfLanes();
+	ModelParameters params;
+	params.SEED = 1000;
+	params.sR_CutOff = sR_cutOff;
+	params.Xmax = params.Ymax = params.Zmax = boxSize;
+	params.qt = scenario.qt;
+	params.DOS_mu = { 1.5, 1.5, 1.5, 1.5 };
+	params.DOS_sigma = { scenario.chargeSigma, scenario.chargeSigma, 0.026, 0.026 };
+	params.charge = { -1.0, 1.0, 0.0, 0.0 };
+	params.v0 = scenario.v0;
+	params.alpha = { 0.15, 0.15, 0.15, 0.15 };
+	params.kBT = scenario.kBT;
+	params.options.fast_math = fastMath;
+
+	std::vector<RunResult> results;
+	for (int r = 0; r < nrOfReplicas; r += lanes) {
+		ReplicaBatch<8> batch(params, morphology, PType::elec, r);
+		batch.runUntil(scenario.maxTime);
+		for (int l = 0; l < lanes && r + l < nrOfReplicas; ++l) {
+			RunResult result;
+			result.counts.fill(0);
+			result.counts[Transition::normalhop] = batch.getNrOfHops(l);
+			result.meanEnergy.fill(NAN);
+			result.deepOccupation.fill(NAN);
+			std::vector<double> energies;
+			for (int s = 0; s < batch.getNrOfSites(); ++s) {
+				energies.push_back(batch.getEnergy(s, l));
+			}
+			std::nth_element(energies.begin(), energies.begin() + energies.size() / 10, energies.end());
+			double deepEnergy = energies[energies.size() / 10];
+			double occupation = 0.0, energy = 0.0, deep = 0.0;
+			for (int s = 0; s < batch.getNrOfSites(); ++s) {
+				double occ = batch.getOccupation(s, l);
+				occupation += occ;
+				energy += occ * batch.getEnergy(s, l);
+				if (batch.getEnergy(s, l) <= deepEnergy) {
+					deep += occ;
+				}
+			}
+			result.meanEnergy[PType::elec] = energy / occupation;
+			result.deepOccupation[PType::elec] = deep / occupation;
+			result.alive[PType::elec] = batch.getNrOfCarriers();
+			results.push_back(result);
+		}
+	}
+	return results;
+}
+
+/* Two sided Welch t-test, returns the p-value */
+double welchTest(const std::vector<double>& a, const std::vector<double>& b) {
+	auto meanVar = [](const std::vector<double>& x) {
+		double mean = 0.0, var = 0.0;
+		for (const auto& v : x) mean += v;
+		mean /= x.size();
+		for (const auto& v : x) var += (v - mean) * (v - mean);
+		return std::pair<double, double>{ mean, var / (x.size() - 1) };
+	};
+	auto [meanA, varA] = meanVar(a);
+	auto [meanB, varB] = meanVar(b);
+	double seA = varA / a.size();
+	double seB = varB / b.size();
+	if (seA + seB == 0.0) {
+		return meanA == meanB ? 1.0 : 0.0;
+	}
+	double t = (meanA - meanB) / std::sqrt(seA + seB);
+	double df = (seA + seB) * (seA + seB) / (seA * seA / (a.size() - 1) + seB * seB / (b.size() - 1));
+	boost::math::students_t dist(df);
+	return 2.0 * boost::math::cdf(boost::math::complement(dist, std::fabs(t)));
+}
+
+/* Two sample Kolmogorov-Smirnov test (asymptotic distribution), returns the p-value */
+double kolmogorovSmirnovTest(std::vector<double> a, std::vector<double> b) {
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+	double d = 0.0;
+	unsigned int i = 0, j = 0;
+	while (i < a.size() && j < b.size()) {
+		double x = std::min(a[i], b[j]);
+		while (i < a.size() && a[i] <= x) ++i;
+		while (j < b.size() && b[j] <= x) ++j;
+		d = std::max(d, std::fabs((double)i / a.size() - (double)j / b.size()));
+	}
+	double ne = (double)a.size() * b.size() / (a.size() + b.size());
+	double lambda = (std::sqrt(ne) + 0.12 + 0.11 / std::sqrt(ne)) * d;
+	double p = 0.0;
+	for (int k = 1; k <= 100; ++k) {
+		p += 2.0 * ((k % 2) ? 1.0 : -1.0) * std::exp(-2.0 * k * k * lambda * lambda);
+	}
+	return std::clamp(p, 0.0, 1.0);
+}
+
+const char* transitionName(int transition) {
+	static const char* names[] = { "normalhop", "decay", "excitonFromElec", "excitonFromHole", "excitonFromElecCT", "excitonFromHoleCT",
+		"singToCTViaElec", "singToCTViaHole", "tripToCTViaElec", "tripToCTViaHole", "CTdisViaHole", "CTdisViaElec", "superbasinExit",
+		"injection", "extraction" };
+	return names[transition];
+}
+
+/* Runs the candidate for all replicas and returns the smallest Holm adjusted p-value of all comparisons with the reference,
+   0 if a superbasin candidate never left a basin (the scenario would not test it) */
+double compare(const std::vector<Eigen::Vector3d>& morphology, const Scenario& scenario, const Candidate& candidate, const std::vector<RunResult>& reference) {
+	std::vector<RunResult> results;
+	long superbasinExits = 0;
+	if (candidate.runAll) {
+		results = candidate.runAll(morphology, scenario);
+	}
+	for (int r = 0; r < nrOfReplicas && !candidate.runAll; ++r) {
+		results.push_back(runOnce(morphology, scenario, &candidate, 1000 + r));
+	}
+	for (const auto& res : results) {
+		superbasinExits += res.counts[Transition::superbasinExit];
+	}
+	RunOptions candidateOptions;
+	candidate.configure(candidateOptions);
+	if (candidateOptions.superbasin) {
+		std::cout << "    superbasin exits: " << superbasinExits << "\n";
+		if (superbasinExits == 0) {
+			return 0.0;
+		}
+	}
+
+	std::vector<std::pair<std::string, Sample>> samples;
+	auto add = [&](const std::string& name, std::function<double(const RunResult&)> observable) {
+		Sample sample;
+		for (const auto& res : reference) sample.reference.push_back(observable(res));
+		for (const auto& res : results) sample.candidate.push_back(observable(res));
+		auto isNan = [](double v) { return std::isnan(v); };
+		if (std::any_of(sample.reference.begin(), sample.reference.end(), isNan) || std::any_of(sample.candidate.begin(), sample.candidate.end(), isNan)) {
+			return; // the observable is not defined in every replica
+		}
+		samples.emplace_back(name, sample);
+	};
+	for (int t = 0; t < nrOfTransitions; ++t) {
+		if (t == Transition::superbasinExit || (t == Transition::normalhop && !candidate.compareHops)) continue;
+		bool seen = false;
+		for (const auto& res : reference) seen = seen || res.counts[t] > 0;
+		if (seen) add(std::string("count ") + transitionName(t), [t](const RunResult& res) { return (double)res.counts[t]; });
+	}
+	for (int t = 0; t < 4; ++t) {
+		add(str(boost::format("mean occupied energy %d") % t), [t](const RunResult& res) { return res.meanEnergy[t]; });
+		add(str(boost::format("deep occupation %d") % t), [t](const RunResult& res) { return res.deepOccupation[t]; });
+	}
+	for (int t = 0; t < 5; ++t) {
+		add(str(boost::format("alive %d") % t), [t](const RunResult& res) { return (double)res.alive[t]; });
+		add(str(boost::format("dead %d") % t), [t](const RunResult& res) { return (double)res.dead[t]; });
+	}
+
+	std::vector<std::pair<double, std::string>> pValues;
+	for (const auto& [name, sample] : samples) {
+		pValues.emplace_back(welchTest(sample.reference, sample.candidate), name);
+	}
+	if (candidate.compareWaitingTimes) {
+		Sample waits;
+		for (const auto& res : reference) {
+			for (unsigned int i = 0; i < res.waitingTimes.size(); i += 25) waits.reference.push_back(res.waitingTimes[i]);
+		}
+		for (const auto& res : results) {
+			for (unsigned int i = 0; i < res.waitingTimes.size(); i += 25) waits.candidate.push_back(res.waitingTimes[i]);
+		}
+		pValues.emplace_back(kolmogorovSmirnovTest(waits.reference, waits.candidate), "waiting times (KS)");
+	}
+
+	/* Holm step-down: the i-th smallest of m p-values is multiplied by m - i, adjusted p-values never decrease */
+	std::sort(pValues.begin(), pValues.end());
+	double minP = 1.0;
+	double adjusted = 0.0;
+	for (unsigned int i = 0; i < pValues.size(); ++i) {
+		const auto& [p, name] = pValues[i];
+		adjusted = std::max(adjusted, std::min(1.0, (pValues.size() - i) * p));
+		minP = std::min(minP, adjusted);
+		if (adjusted < alpha) {
+			std::cout << boost::format("    %-32s p = %.2e (Holm adjusted %.2e)\n") % name % p % adjusted;
+		}
+	}
+	return minP;
+}
+
+/* The event loops specialised for one carrier type must give exactly the same runs as the full event loop */
+bool checkSpecialization(const std::vector<Eigen::Vector3d>& morphology) {
+	bool passed = true;
+	std::vector<Scenario> scenarios{
+		{ "electrons only", { 6, 0, 0, 0 }, 0.026, 2000.0, { 1.0, 1.0, 1.0, 1.0 } },
+		{ "holes only", { 0, 6, 0, 0 }, 0.026, 2000.0, { 1.0, 1.0, 1.0, 1.0 } },
+	};
+	Candidate specialised{ "specialised", [](RunOptions& opt) { opt.specialize_types = true; }, true, true, {} };
+	Candidate full{ "full", [](RunOptions& opt) { opt.specialize_types = false; }, true, true, {} };
+	/* Without recorded waiting times the plain loop runs, compiled without any of the optional features */
+	Candidate plain{ "plain", [](RunOptions& opt) { opt.specialize_types = true; opt.record_waitingTimes = false; }, false, true, {} };
+	auto sameEnergies = [](const RunResult& a, const RunResult& b) { // types that never occupied a site have NaN energies
+		return std::equal(a.meanEnergy.begin(), a.meanEnergy.end(), b.meanEnergy.begin(),
+			[](double x, double y) { return x == y || (std::isnan(x) && std::isnan(y)); });
+	};
+	for (const auto& scenario : scenarios) {
+		for (int seed = 1000; seed < 1003; ++seed) {
+			RunResult a = runOnce(morphology, scenario, &specialised, seed);
+			RunResult b = runOnce(morphology, scenario, &full, seed);
+			RunResult c = runOnce(morphology, scenario, &plain, seed);
+			passed = passed && a.counts == b.counts && a.waitingTimes == b.waitingTimes && a.alive == b.alive && a.dead == b.dead;
+			passed = passed && c.counts == b.counts && sameEnergies(c, b) && c.alive == b.alive && c.dead == b.dead;
+		}
+	}
+	std::cout << "Specialised event loops identical to the full event loop: " << (passed ? "PASS" : "FAIL") << "\n";
+	return passed;
+}
+
+/* Open system with two electrodes at the same level and no field: the steady state is the grand canonical equilibrium,
+   so the mean number of carriers must be the sum of the Fermi-Dirac occupations of all sites. Also checks that every
+   carrier is accounted for and that the particle slots are reused. */
+bool checkElectrodes(const std::vector<Eigen::Vector3d>& morphology) {
+	const double kBT = 0.026;
+	const double barrier = 0.15;
+	const double warmupTime = 2000.0;
+	const double maxTime = 20000.0;
+	double meanCarriers = 0.0, expectedCarriers = 0.0;
+	bool conserved = true, recycled = true;
+	for (int seed = 1000; seed < 1000 + nrOfReplicas; ++seed) {
+		RunOptions options;
+		options.electrodes = true;
+		options.electrode_barrierLeft = barrier;
+		options.electrode_barrierRight = barrier;
+		options.verbose = false;
+		PBC pbc(boxSize, boxSize, boxSize);
+		RateEngine rate_engine({ 1.0, 1.0, 1.0, 1.0 }, { 0.15, 0.15, 0.15, 0.15 }, { -1.0, 1.0, 0.0, 0.0 }, 0.0, kBT, pbc);
+		RandomEngine random_engine(seed);
+		random_engine.initializeParameters({ 1.5, 1.5, 1.5, 1.5 }, { 0.052, 0.052, 0.026, 0.026 });
+
+		KmcRun run{ rate_engine, pbc, random_engine, 0, { 0, 0, 0, 0 }, "", sR_cutOff, lR_cutOff, options };
+		run.setSites(morphology);
+		auto countAlive = [&]() {
+			return std::count_if(run.getParticles().begin(), run.getParticles().end(), [](const Particle& part) { return part.isAlive(); });
+		};
+		run.runUntil(warmupTime);
+		long aliveBefore = countAlive();
+		std::array<long, nrOfTransitions> countsBefore = run.getTransitionCounts();
+		std::vector<double> occupationBefore;
+		for (unsigned int i = 0; i < morphology.size(); ++i) {
+			occupationBefore.push_back(run.getOccupation(i, PType::elec));
+		}
+		run.runUntil(maxTime);
+
+		long injected = run.getTransitionCounts()[Transition::injection] - countsBefore[Transition::injection];
+		long extracted = run.getTransitionCounts()[Transition::extraction] - countsBefore[Transition::extraction];
+		for (unsigned int i = 0; i < morphology.size(); ++i) {
+			double energy = run.getSites()[i].getEnergy(PType::elec);
+			expectedCarriers += 1.0 / (1.0 + std::exp((energy - (1.5 - barrier)) / kBT));
+			meanCarriers += (run.getOccupation(i, PType::elec) - occupationBefore[i]) / (maxTime - warmupTime);
+		}
+		const Electrodes& electrodes = run.getElectrodes();
+		conserved = conserved && countAlive() == aliveBefore + injected - extracted
+			&& run.getTransitionCounts()[Transition::injection] == electrodes.getInjected(Electrodes::left) + electrodes.getInjected(Electrodes::right);
+		recycled = recycled && (long)run.getParticles().size() * 10 < injected;
+	}
+	double relativeError = std::fabs(meanCarriers / expectedCarriers - 1.0);
+	bool passed = conserved && recycled && relativeError < 0.05;
+	std::cout << boost::format("Electrodes: mean number of carriers %.3f, Fermi-Dirac %.3f (relative error %.3f)%s%s  %s\n")
+		% (meanCarriers / nrOfReplicas) % (expectedCarriers / nrOfReplicas) % relativeError % (conserved ? "" : ", carriers not conserved")
+		% (recycled ? "" : ", particle slots not reused") % (passed ? "PASS" : "FAIL");
+	return passed;
+}
+
+/* Compares the fast math rates with the exact ones, returns false if an error exceeds its bound */
+bool checkFastMath() {
+	std::mt19937_64 rng(77);
+	double expError = 0.0, pow6Error = 0.0, rateError = 0.0;
+	std::uniform_real_distribution<double> exponent(-700.0, 700.0), base(0.01, 100.0);
+	for (int i = 0; i < 1000000; ++i) {
+		double x = exponent(rng);
+		expError = std::max(expError, std::fabs(FastMath::exp(x) / std::exp(x) - 1.0));
+		double y = base(rng);
+		pow6Error = std::max(pow6Error, std::fabs(FastMath::pow6(y) / std::pow(y, 6) - 1.0));
+	}
+
+	/* Rates of random hops, both ways */
+	PBC pbc(boxSize, boxSize, boxSize);
+	RateEngine exact({ 1.0, 1.0, 1.0, 1.0 }, { 0.15, 0.15, 0.15, 0.15 }, { -1.0, 1.0, 0.0, 0.0 }, 0.05, 0.026, pbc);
+	RateEngine fast = exact;
+	fast.setFastMath(true);
+	std::uniform_real_distribution<double> coord(0.0, boxSize), energy(1.0, 2.0);
+	for (int i = 0; i < 100000; ++i) {
+		Site one(Eigen::Vector3d(coord(rng), coord(rng), coord(rng)), { energy(rng), energy(rng), energy(rng), energy(rng) });
+		Site two(Eigen::Vector3d(coord(rng), coord(rng), coord(rng)), { energy(rng), energy(rng), energy(rng), energy(rng) });
+		std::array<std::pair<double, double>, 4> rates{ {
+			{ exact.millerAbrahams(one, two, PType::elec), fast.millerAbrahams(one, two, PType::elec) },
+			{ exact.millerAbrahamsGEN(two, one, PType::hole), fast.millerAbrahamsGEN(two, one, PType::hole) },
+			{ exact.millerAbrahamsCT(one, two, PType::elec), fast.millerAbrahamsCT(one, two, PType::elec) },
+			{ exact.forster(one, two), fast.forster(one, two) } } };
+		for (const auto& [r, f] : rates) {
+			if (r > 0.0) rateError = std::max(rateError, std::fabs(f / r - 1.0));
+		}
+	}
+
+	/* A rate is a product of at most two approximations and a few roundings */
+	bool passed = expError <= FastMath::maxExpError && pow6Error <= 1e-14 && rateError <= 2.0 * FastMath::maxExpError + 1e-14;
+	std::cout << boost::format("Fast math relative errors: exp %.2e (bound %.0e), pow6 %.2e, rates %.2e  %s\n")
+		% expError % FastMath::maxExpError % pow6Error % rateError % (passed ? "PASS" : "FAIL");
+	return passed;
+}
+
+}
+
+int main() {
+	std::vector<Eigen::Vector3d> morphology = makeMorphology();
+
+	std::vector<Scenario> scenarios{
+		{ "electrons", { 6, 0, 0, 0 }, 0.026, 2000.0, { 1.0, 1.0, 1.0, 1.0 } },
+		{ "trapped electrons", { 6, 0, 0, 0 }, 0.026, 20000.0, { 1.0, 1.0, 1.0, 1.0 }, 0.12 },
+		{ "charges", { 3, 3, 0, 0 }, 0.1, 2000.0, { 1.0, 1.0, 0.01, 0.01 } },
+		{ "trapped charges", { 3, 3, 0, 0 }, 0.026, 20000.0, { 1.0, 1.0, 0.01, 0.01 }, 0.12 },
+		{ "singlets", { 0, 0, 0, 4 }, 0.3, 200.0, { 1.0, 1.0, 0.01, 1e7 } },
+		{ "triplets", { 0, 0, 4, 0 }, 0.3, 2000.0, { 1.0, 1.0, 0.01, 0.01 } },
+	};
+
+	std::vector<Candidate> candidates{
+		{ "superbasin", [](RunOptions& opt) { opt.superbasin = true; }, false, false, { "electrons", "trapped electrons", "trapped charges" } },
+		{ "dilute", [](RunOptions& opt) { opt.dilute = true; opt.dilute_threads = 2; }, false, true, { "electrons", "charges" } },
+		{ "batch", [](RunOptions& opt) { opt.batch = true; opt.batch_threads = 2; }, true, true, { "electrons", "trapped electrons" } },
+		{ "Forster pruning", [](RunOptions& opt) { opt.lR_pruneFraction = 1e-3; }, false, true, { "singlets" } },
+		{ "fast math", [](RunOptions& opt) { opt.fast_math = true; }, true, true, { "electrons", "charges", "singlets", "triplets" } },
+		{ "replica batch", [](RunOptions&) {}, false, true, { "electrons", "trapped electrons" }, true, 1.0,
+			[](const std::vector<Eigen::Vector3d>& morphology, const Scenario& scenario) { return runReplicaBatch(morphology, scenario, false); } },
+		{ "replica batch (fast)", [](RunOptions&) {}, false, true, { "electrons" }, true, 1.0,
+			[](const std::vector<Eigen::Vector3d>& morphology, const Scenario& scenario) { return runReplicaBatch(morphology, scenario, true); } },
+		{ "control (kBT x1.3)", [](RunOptions&) {}, true, true, { "electrons" }, false, 1.3 },
+	};
+
+	bool success = checkFastMath();
+	success = checkSpecialization(morphology) && success;
+	success = checkElectrodes(morphology) && success;
+	for (const auto& scenario : scenarios) {
+		auto testsScenario = [&](const Candidate& candidate) {
+			return std::find(candidate.scenarios.begin(), candidate.scenarios.end(), scenario.name) != candidate.scenarios.end();
+		};
+		if (std::none_of(candidates.begin(), candidates.end(), testsScenario)) {
+			continue;
+		}
+		std::vector<RunResult> reference;
+		for (int r = 0; r < nrOfReplicas; ++r) {
+			reference.push_back(runOnce(morphology, scenario, nullptr, 1000 + r));
+		}
+		std::array<long, nrOfTransitions> total{ 0 };
+		for (const auto& res : reference) {
+			for (int t = 0; t < nrOfTransitions; ++t) total[t] += res.counts[t];
+		}
+		std::cout << "Scenario " << scenario.name << ", transitions in the reference:";
+		for (int t = 0; t < nrOfTransitions; ++t) {
+			if (total[t] > 0) std::cout << " " << transitionName(t) << "=" << total[t];
+		}
+		std::cout << "\n";
+
+		for (const auto& candidate : candidates) {
+			if (!testsScenario(candidate)) continue;
+			double minP = compare(morphology, scenario, candidate, reference);
+			bool equivalent = minP >= alpha;
+			bool passed = (equivalent == candidate.expectEquivalent);
+			success = success && passed;
+			std::cout << boost::format("  %-20s min adjusted p = %.2e  %s\n") % candidate.name % minP % (passed ? "PASS" : "FAIL");
+		}
+	}
+
+	std::cout << (success ? "All candidates are statistically equivalent to the reference." : "Statistical equivalence test FAILED.") << std::endl;
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}